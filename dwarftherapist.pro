@@ -129,6 +129,14 @@ HEADERS += inc/win_structs.h \
     inc/dwarfjob.h \
     inc/dwarfdetailswidget.h \
     inc/dwarf.h \
+    inc/dwarfdata.h \
+    inc/dwarfexpression.h \
+    inc/dwarfdecoder.h \
+    inc/creaturegatherer.h \
+    inc/laborset.h \
+    inc/stringpool.h \
+    inc/gamedatacache.h \
+    inc/nameresolver.h \
     inc/dfinstance.h \
     inc/defines.h \
     inc/customprofession.h \
@@ -149,6 +157,7 @@ HEADERS += inc/win_structs.h \
     inc/grid_view/gridview.h \
     inc/grid_view/columntypes.h \
     inc/grid_view/attributecolumn.h \
+    inc/grid_view/expressioncolumn.h \
     inc/docks/skilllegenddock.h \
     inc/docks/gridviewdock.h \
     inc/docks/dwarfdetailsdock.h \
@@ -188,6 +197,12 @@ SOURCES += src/viewmanager.cpp \
     src/dwarftherapist.cpp \
     src/dwarfdetailswidget.cpp \
     src/dwarf.cpp \
+    src/dwarfdecoder.cpp \
+    src/dwarfexpression.cpp \
+    src/creaturegatherer.cpp \
+    src/stringpool.cpp \
+    src/gamedatacache.cpp \
+    src/nameresolver.cpp \
     src/dfinstance.cpp \
     src/customprofession.cpp \
     src/customcolor.cpp \
@@ -205,6 +220,7 @@ SOURCES += src/viewmanager.cpp \
     src/grid_view/happinesscolumn.cpp \
     src/grid_view/gridview.cpp \
     src/grid_view/attributecolumn.cpp \
+    src/grid_view/expressioncolumn.cpp \
     src/docks/skilllegenddock.cpp \
     src/docks/gridviewdock.cpp \
     src/docks/dwarfdetailsdock.cpp \
@@ -102,6 +102,32 @@ static unsigned char const cp437FromUnicode[256] = {
 };
 
 
+/*! Decode CP437 bytes straight through the lookup table above, stopping at the
+first NUL. Unlike CP437Codec this needs no codec instance, so it is cheap to
+call for every string we pull out of DF.
+*/
+static inline QString cp437_to_unicode(const char *in, int length) {
+	QString str;
+	str.resize(length);
+	QChar *out = str.data();
+	int i = 0;
+	for (; i < length && in[i]; ++i)
+		out[i] = QChar(cp437ToUnicode[in[i] & 0xFF]);
+	str.truncate(i);
+	return str;
+}
+
+//! encode str for DF, anything outside of CP437 becomes '?'
+static inline QByteArray cp437_from_unicode(const QString &str) {
+	QByteArray result(str.size(), '?');
+	for (int i = 0; i < str.size(); ++i) {
+		ushort ch = str.at(i).unicode();
+		if (ch < 0x0100)
+			result[i] = (char)cp437FromUnicode[ch];
+	}
+	return result;
+}
+
 class CP437Codec : public QTextCodec {
 public:
 	CP437Codec(){}
@@ -0,0 +1,65 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef CREATURE_GATHERER_H
+#define CREATURE_GATHERER_H
+
+#include <QtCore>
+#include "dfinstance.h"
+#include "dwarfdecoder.h"
+
+/*! Plans the remote reads needed to fill in CreatureSnapshots. Rather than
+chasing each creature's pointers one blocking read at a time, the pointer graph
+is walked breadth first: every pointer discovered at one level is fetched for
+all creatures in a single DFInstance::read_raw_batch() call, and the results
+feed the next level. The number of round trips depends on the depth of the
+graph, not on the number of dwarves.
+*/
+class CreatureGatherer {
+public:
+    typedef DFInstance::ScatterRead ScatterRead;
+
+    CreatureGatherer(DFInstance *df, const DwarfDecodeContext &ctx);
+
+    /*! level 0: fetch the creature struct at each address in one batch.
+    Snapshots whose struct could not be read come back with empty bytes
+    */
+    QVector<CreatureSnapshot> gather_creatures(const QVector<VIRTADDR> &addrs);
+
+    /*! follow the pointers out of already captured creature structs:
+      1. names, souls vector, current job struct and its sub-job string,
+         states vector (idle creatures only)
+      2. first soul struct, state entries
+      3. skills vector of the first soul
+      4. skill entries
+    */
+    void gather_details(QVector<CreatureSnapshot> &snaps);
+
+private:
+    DFInstance *m_df;
+    const DwarfDecodeContext &m_ctx;
+
+    //! issue several groups of reads as a single batch
+    void read_level(const QList<QVector<ScatterRead>*> &groups);
+};
+
+#endif // CREATURE_GATHERER_H
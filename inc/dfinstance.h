@@ -62,9 +62,43 @@ public:
     virtual qint16 read_short(const VIRTADDR &addr);
     virtual qint32 read_int(const VIRTADDR &addr);
 
+    //! one block of memory to fetch as part of a read_raw_batch() call
+    struct ScatterRead {
+        ScatterRead(const VIRTADDR &a = 0, int b = 0) : addr(a), bytes(b) {}
+        VIRTADDR addr;
+        int bytes;
+        QByteArray data; // filled in by read_raw_batch(), empty on failure
+    };
+
+    /*! fetch many blocks in a single pass. Blocks are sorted by address and
+    neighbours are merged into one larger read, so a batch costs a handful of
+    round trips no matter how many blocks it holds
+    */
+    virtual void read_raw_batch(QVector<ScatterRead> &reads);
+    //! read of the body of the std::vector whose header was copied into buf at offset
+    ScatterRead vector_body(const QByteArray &buf, uint offset);
+    //! the (valid) pointers held in a vector body fetched with vector_body()
+    QVector<VIRTADDR> vector_pointers(const QByteArray &body);
+
     // memory reading
     virtual QVector<VIRTADDR> enumerate_vector(const VIRTADDR &addr) = 0;
     virtual QString read_string(const VIRTADDR &addr) = 0;
+    /*! read a std::string by looking at its header first and then copying
+    exactly as many characters as it holds (short strings stored inside the
+    header need no second read)
+    */
+    QString read_std_string(const VIRTADDR &addr);
+    //! read_std_string() for each address, done as batched passes
+    virtual QVector<QString> read_strings(const QVector<VIRTADDR> &addrs);
+    /*! read the std::string found at each of offsets inside each struct in
+    structs. All the struct headers are fetched in one read_raw_batch() and
+    all the character buffers in a second one. Results are ordered struct by
+    struct, so the string at offsets[j] of structs[i] is at
+    i * offsets.size() + j. Offsets of 0xFFFFFFFF (missing from the layout)
+    give empty strings.
+    */
+    QVector<QString> read_struct_strings(const QVector<VIRTADDR> &structs,
+                                         const QVector<uint> &offsets);
 
     QVector<VIRTADDR> scan_mem(const QByteArray &needle, const uint start_addr=0, const uint end_addr=0xffffffff);
     QByteArray get_data(const VIRTADDR &addr, int size);
@@ -89,7 +123,8 @@ public:
     MemoryLayout *memory_layout() {return m_layout;}
     void read_raws();
     QVector<Dwarf*> load_dwarves();
-    QVector<Squad*> load_squads();
+    //! dwarves_by_ref_id maps Dwarf::get_squad_ref_id() to the dwarf
+    QVector<Squad*> load_squads(const QHash<int, Dwarf*> &dwarves_by_ref_id);
 
     // Set layout
     void set_memory_layout(MemoryLayout * layout) { m_layout = layout; }
@@ -117,20 +152,37 @@ public:
     static const int STRING_LENGTH_OFFSET = 16; // Relative to STRING_BUFFER_OFFSET
     static const int STRING_CAP_OFFSET = 20;    // Relative to STRING_BUFFER_OFFSET
     static const int VECTOR_POINTER_OFFSET = 4;
+    static const int STRING_REP_SIZE = 0;      // Unused, length is in the header
 #endif
 #ifdef Q_WS_X11
     static const int STRING_BUFFER_OFFSET = 0;
     static const int STRING_LENGTH_OFFSET = 0; // Dummy value
     static const int STRING_CAP_OFFSET = 0;    // Dummy value
     static const int VECTOR_POINTER_OFFSET = 0;
+    static const int STRING_REP_SIZE = 12;     // length, capacity, refcount before the characters
 #endif
 #ifdef Q_WS_MAC
     static const int STRING_BUFFER_OFFSET = 0;
     static const int STRING_LENGTH_OFFSET = 0; // Dummy value
     static const int STRING_CAP_OFFSET = 0;    // Dummy value
     static const int VECTOR_POINTER_OFFSET = 0;
+    static const int STRING_REP_SIZE = 12;     // length, capacity, refcount before the characters
 #endif
 
+    //! where the characters of a std::string live (len is -1 when unknown)
+    struct StringLocation {
+        StringLocation() : buffer(0), len(0) {}
+        VIRTADDR buffer;
+        int len;
+    };
+    /*! work out where the characters are for the std::string whose header was
+    copied into data at offset (the header itself lives at header_addr)
+    */
+    StringLocation locate_string(const QByteArray &data, uint offset,
+                                 const VIRTADDR &header_addr);
+    //! number of bytes of a std::string header locate_string() looks at
+    int string_header_size();
+
     // handy util methods
     virtual quint32 calculate_checksum() = 0;
     MemoryLayout *get_memory_layout(QString checksum, bool warn = true);
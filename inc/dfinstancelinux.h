@@ -38,6 +38,7 @@ public:
     bool find_running_copy(bool connect_anyway = false);
     QVector<VIRTADDR> enumerate_vector(const uint &addr);
     int read_raw(const VIRTADDR &addr, int bytes, QByteArray &buffer);
+    void read_raw_batch(QVector<ScatterRead> &reads);
     QString read_string(const VIRTADDR &addr);
 
     // Writing
@@ -54,7 +55,7 @@ public:
 protected:
     uint calculate_checksum();
 private:
-    QFile m_memory_file;
+    QFile m_memory_file; // only held open for the duration of a batch read
 };
 
 #endif // DFINSTANCE_H
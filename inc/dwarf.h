@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <QtGui>
 
 #include "skill.h"
+#include "dwarfdata.h"
 #include "utils.h"
 
 class DFInstance;
@@ -36,10 +37,12 @@ class Dwarf : public QObject
 {
     Q_OBJECT
     friend class Squad;
-    Dwarf(DFInstance *df, const uint &addr, QObject *parent=0); //private, use the static get_dwarf() method
+    Dwarf(DFInstance *df, const DwarfData &data, QObject *parent=0); //private, use the static get_dwarf() methods
 
 public:
     static Dwarf* get_dwarf(DFInstance *df, const VIRTADDR &address);
+    //! wrap an already decoded creature (see DFInstance::load_dwarves())
+    static Dwarf* get_dwarf(DFInstance *df, const DwarfData &data);
     virtual ~Dwarf();
 
     typedef enum {
@@ -55,61 +58,64 @@ public:
 
     // getters
     //! Return the memory address (in hex) of this creature in the remote DF process
-    VIRTADDR address() {return m_address;}
+    VIRTADDR address() {return m_data.address;}
 
     //! return the the unique id for this creature
-    int id() {return m_id;}
+    int id() {return m_data.id;}
 
     //! true if the creature is male, false if female or "it"
-    Q_INVOKABLE bool is_male() {return m_is_male;}
+    Q_INVOKABLE bool is_male() {return m_data.is_male;}
 
     //! return a text version of this dwarf's profession (will use custom profession if set)
     QString profession();
 
     //! return the raw game-set profession for a dwarf
-    Q_INVOKABLE int raw_profession() {return m_raw_profession;}
+    Q_INVOKABLE int raw_profession() {return m_data.raw_profession;}
 
     //! custom profession string (if set)
     QString custom_profession_name() {return m_pending_custom_profession;}
 
     //! return a printable name for this dwarf based on user-settings (may include nickname/firstname or both)
-    Q_INVOKABLE QString nice_name() {return m_nice_name;}
+    Q_INVOKABLE QString nice_name() {check_names(); return m_nice_name;}
 
     //! return a printable name for this dwarf where each dwarven word is translated to english (not game human)
-    QString translated_name() {return m_translated_name;}
+    QString translated_name() {check_names(); return m_translated_name;}
 
     //! return the string nickname for this dwarf (if set)
     QString nickname() {return m_pending_nick_name;}
 
     //! return the happiness level of this dwarf
-    DWARF_HAPPINESS get_happiness() {return m_happiness;}
+    DWARF_HAPPINESS get_happiness() {return static_cast<DWARF_HAPPINESS>(m_data.happiness);}
 
     //! return the raw happiness score for this dwarf
-    Q_INVOKABLE int get_raw_happiness() {return m_raw_happiness;}
+    Q_INVOKABLE int get_raw_happiness() {return m_data.raw_happiness;}
 
     //! return this dwarf's strength attribute score
-    Q_INVOKABLE int strength() {return m_strength;}
+    Q_INVOKABLE int strength() {return m_data.strength;}
 
     //! return this dwarf's agility attribute score
-    Q_INVOKABLE int agility() {return m_agility;}
+    Q_INVOKABLE int agility() {return m_data.agility;}
 
     //! return this dwarf's toughness attribute score
-    Q_INVOKABLE int toughness() {return m_toughness;}
+    Q_INVOKABLE int toughness() {return m_data.toughness;}
 
     //! return this dwarf's squad reference id
-    Q_INVOKABLE int get_squad_ref_id() { return m_squad_ref_id; }
+    Q_INVOKABLE int get_squad_ref_id() { return m_data.squad_ref_id; }
 
     //! return this dwarf's highest skill
     Skill highest_skill();
 
     //! sum total of all skill levels in any skill
-    Q_INVOKABLE int total_skill_levels();
+    Q_INVOKABLE int total_skill_levels() {return m_data.total_skill_levels;}
+
+    //! number of skills this dwarf is legendary (or better) in
+    Q_INVOKABLE int legendary_skills() {return m_data.legendary_skills;}
 
     //! number of activated labors
     Q_INVOKABLE int total_assigned_labors();
 
     //! return the sum total of all xp this dwarf has earned
-    int total_xp() {return m_total_xp;}
+    int total_xp() {return m_data.total_xp;}
 
     //! return the probable migration wave this dwarf arrived in (purely a guess)
     int migration_wave() {return m_migration_wave;}
@@ -117,21 +123,33 @@ public:
     //! return true if the dwarf's raw_profession is a military professions
     Q_INVOKABLE bool active_military();
 
-    //! return a vector of Skill objects that this dwarf has experience in
-    QVector<Skill> *get_skills() {return &m_skills;}
+    //! return a vector of Skill objects that this dwarf has experience in (ordered by skill id)
+    QVector<Skill> get_skills();
 
     //! return a skill object by skill_id
     const Skill get_skill(int skill_id);
 
-    //! return all labors that the user has toggled, but not comitted to DF yet
+    //! return all labors, then military preferences, that the user has toggled, but not comitted to DF yet
     QVector<int> get_dirty_labors(); // returns labor ids
 
+    //! labors whose pending on/off state differs from the game's
+    LaborSet dirty_labor_set() const;
+
+    //! military preferences whose pending value differs from the game's
+    LaborSet dirty_pref_set() const;
+
+    //! ids (labors and preferences) that are on once pending changes are committed
+    const LaborSet &enabled_labor_set() const { return m_pending_labors.enabled(); }
+
     //! return true if the labor specified by labor_id is enabled or pending enabled
     Q_INVOKABLE bool labor_enabled(int labor_id);
 
     //! return true if the labor specified by labor_id has been toggled and not committed
     Q_INVOKABLE bool is_labor_state_dirty(int labor_id);
 
+    //! return true if the preference specified by labor_id has been changed and not committed
+    bool is_pref_state_dirty(int labor_id);
+
     //! return the numeric value of a preference setting (uses labor ids for offset)
     short pref_value(const int &labor_id);
 
@@ -141,25 +159,30 @@ public:
     /*! return this dwarf's numeric score for the trait specified by trait_id,
     will return -1 if the trait is in the average range (non-extreme values)
     */
-    Q_INVOKABLE short trait(int trait_id) {return m_traits.value(trait_id, -1);}
+    Q_INVOKABLE short trait(int trait_id) {
+        if (trait_id < 0 || trait_id >= DwarfData::TRAIT_COUNT)
+            return -1;
+        return m_data.traits[trait_id];
+    }
 
     //! returns the numeric rating for the this dwarf in the skill specified by skill_id
-    short get_rating_by_skill(int skill_id);
+    short get_rating_by_skill(int skill_id) {
+        if (!m_data.has_skill(skill_id))
+            return -1;
+        return m_data.skill_ratings[skill_id];
+    }
 
     //! returns the numeric rating for the this dwarf in the skill associated with the labor specified by labor_id
     Q_INVOKABLE short get_rating_by_labor(int labor_id);
 
-    //! return a hashmap of trait_id to trait score for this dwarf
-    const QHash<int, short> &traits() {return m_traits;}
-
     //! return the text string describing what this dwarf is currently doing ("Idle", "Construct Rock Door" etc...)
-    const QString &current_job() {return m_current_job;}
+    const QString &current_job() {return m_data.current_job;}
 
     //! return the id of the job this dwarf is currently doing
-    const short &current_job_id() {return m_current_job_id;}
+    const short &current_job_id() {return m_data.current_job_id;}
 
     //! return the id of the sub job this dwarf is currently doing
-    const QString &current_sub_job_id() { return m_current_sub_job_id; }
+    const QString &current_sub_job_id() { return m_data.current_sub_job_id; }
 
     //! return the total number of changes to this dwarf are uncommitted
     int pending_changes();
@@ -215,17 +238,20 @@ public:
     QTreeWidgetItem *get_pending_changes_tree();
 
     //! convenience hack allowing Dwarf objects to know where they live in the gridview model
-    QModelIndex m_name_idx;
+    QPersistentModelIndex m_name_idx;
 
     //! get's a list of QActions that can be activated on this dwarf, suitable for adding to Toolbars or context menus
-    QList<QAction*> get_actions() {return m_actions;}
+    QList<QAction*> get_actions();
+
+    //! called when global user settings change (affects how every dwarf's name is shown)
+    static void read_settings();
 
     //! returns true if this dwarf can have labors specified on it
-    Q_INVOKABLE bool can_set_labors() {return m_can_set_labors;}
+    Q_INVOKABLE bool can_set_labors() {return m_data.can_set_labors;}
 
     QString first_name() const {
         //qDebug() << "first_name called (from script?)";
-        return m_first_name;
+        return m_data.first_name;
     }
 
     QString squad_name() const {
@@ -233,12 +259,10 @@ public:
     }
 
     uint turn_count() const {
-        return m_turn_count;
+        return m_data.turn_count;
     }
 
     public slots:
-        //! called when global user settings change
-        void read_settings();
         //! show a dialog with a memory dump for this dwarf...
         void dump_memory();
         //! dump dwarf memory to a file using the dwarf's name
@@ -253,74 +277,34 @@ public:
 
 
 private:
-    int m_id; // each creature in the game has a unique serial ID
     DFInstance *m_df;
     MemoryLayout *m_mem;
-    VIRTADDR m_address; // start of the structure in DF's memory space
-    VIRTADDR m_first_soul; // start of 1st soul for this creature
-    int m_race_id; // each creature has racial ID
-    DWARF_HAPPINESS m_happiness; // enum value of happiness
-    int m_raw_happiness; // raw score before being turned into an enum
-    bool m_is_male;
-    bool m_show_full_name;
-    int m_total_xp;
+    DwarfData m_data; // everything read from the game, see DwarfDecoder
     int m_migration_wave;
     Q_PROPERTY(QString first_name READ first_name) // no setters (read-only)
-    QString m_first_name; // set by game
-    QString m_nick_name; // set by user
     QString m_pending_nick_name; // used when not committed yet
-    QString m_last_name; // last name in dwarven
-    QString m_translated_last_name; // last name in human english
     QString m_nice_name; // full name (depends on settings)
     QString m_translated_name; // full name using human english last name
-    QString m_custom_profession; // set by user
     QString m_pending_custom_profession; // uncommitted
-    QString m_profession; // name of profession set by game
-    int m_raw_profession; // id of profession set by game
-    bool m_can_set_labors; // used to prevent cheating
-    int m_strength;
-    int m_agility;
-    int m_toughness;
-    short m_current_job_id;
-    QString m_current_job;
-    QString m_current_sub_job_id;
-    QVector<Skill> m_skills;
-    QHash<int, short> m_traits;
-    QMap<int, ushort> m_labors;
-    QMap<int, ushort> m_pending_labors;
-    QList<QAction*> m_actions; // actions suitable for context menus
-    int m_squad_ref_id; //Dwarf reference that appears to be used by squad
+    //! pending labor and military preference bytes, see DwarfData::labors
+    LaborValues m_pending_labors;
     QString m_squad_name; //The name of the squad that the dwarf belongs to (if any)
-    uint m_turn_count; // Dwarf turn count from start of fortress (as best we know)
-
-    // these methods read data from raw memory
-    void read_id();
-    void read_caste();
-    void read_race();
-    void read_first_name();
-    void read_last_name();
-    void read_nick_name();
-    void read_profession();
-    void read_labors();
-    void read_happiness();
-    void read_current_job();
-    void read_souls();
-    void read_skills();
-    void read_traits();
-    void read_squad_ref_id();
-    void read_turn_count();
-
-    // utility methods to assist with reading names made up of several words
-    // from the language tables
-    QString word_chunk(uint word, bool use_generic=false);
-    QString read_chunked_name(const VIRTADDR &addr, bool use_generic=false);
-    QString read_squad_name(bool use_generic=false);
+    int m_names_generation; // value of s_names_generation when names were built
+
+    static bool s_show_full_name;
+    static int s_names_generation; // bumped when name settings change
+    static QList<QAction*> s_actions; // context actions shared by all dwarves
+
+    //! replace everything we know from the game with data, dropping pending changes
+    void set_data(const DwarfData &data);
 
     // assembles component names into a nicely formatted single string
     void calc_names();
-
-signals:
-    void name_changed();
+    // rebuild names if the name settings changed since they were built
+    void check_names() {
+        if (m_names_generation != s_names_generation)
+            calc_names();
+    }
 };
 
 #endif // DWARF_H
@@ -0,0 +1,139 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef DWARF_DATA_H
+#define DWARF_DATA_H
+
+#include <QtCore>
+#include "laborset.h"
+#include "utils.h"
+
+/*! Everything we decode about a single creature from DF's memory. This is a
+plain value type with no QObject baggage so it can be filled in on worker
+threads and then handed to the Dwarf object that owns it on the GUI thread.
+Skills and traits live in fixed arrays indexed by id, labors in a bitset and
+the strings are interned (see StringPool), so copying one is cheap.
+*/
+struct DwarfData {
+    enum {
+        MAX_SKILLS = 128, // highest skill id we know of is 115
+        TRAIT_COUNT = 30,
+        LEGENDARY_RATING = 15
+    };
+
+    DwarfData()
+        : address(0)
+        , first_soul(0)
+        , soul_count(0)
+        , id(-1)
+        , race_id(-1)
+        , flags1(0)
+        , flags2(0)
+        , is_male(true)
+        , raw_happiness(0)
+        , happiness(0)
+        , total_xp(0)
+        , raw_profession(-1)
+        , can_set_labors(false)
+        , strength(-1)
+        , agility(-1)
+        , toughness(-1)
+        , current_job_id(-1)
+        , squad_ref_id(-1)
+        , turn_count(0)
+    {
+        clear_skills();
+        for (int i = 0; i < TRAIT_COUNT; ++i)
+            traits[i] = -1;
+    }
+
+    void clear_skills() {
+        for (int i = 0; i < MAX_SKILLS; ++i) {
+            skill_ratings[i] = -1;
+            skill_exp[i] = 0;
+        }
+        skill_mask[0] = 0;
+        skill_mask[1] = 0;
+        highest_skill_id = -1;
+        total_skill_levels = 0;
+        legendary_skills = 0;
+    }
+
+    bool has_skill(int skill_id) const {
+        if (skill_id < 0 || skill_id >= MAX_SKILLS)
+            return false;
+        return (skill_mask[skill_id >> 6] >> (skill_id & 63)) & 1;
+    }
+
+    void set_skill(int skill_id, uint exp, short rating) {
+        if (skill_id < 0 || skill_id >= MAX_SKILLS)
+            return;
+        skill_ratings[skill_id] = rating;
+        skill_exp[skill_id] = exp;
+        skill_mask[skill_id >> 6] |= Q_UINT64_C(1) << (skill_id & 63);
+        if (rating > 0) {
+            total_skill_levels += rating;
+            if (highest_skill_id < 0 || rating > skill_ratings[highest_skill_id])
+                highest_skill_id = skill_id;
+        }
+        if (rating >= LEGENDARY_RATING)
+            ++legendary_skills;
+    }
+
+    VIRTADDR address; // start of the structure in DF's memory space
+    VIRTADDR first_soul; // start of 1st soul for this creature
+    int soul_count;
+    int id; // each creature in the game has a unique serial ID
+    int race_id; // each creature has racial ID
+    quint32 flags1;
+    quint32 flags2;
+    bool is_male;
+    int raw_happiness; // raw score before being turned into an enum
+    int happiness; // Dwarf::DWARF_HAPPINESS value of raw_happiness
+    int total_xp;
+    QString first_name; // set by game
+    QString nick_name; // set by user
+    QString last_name; // last name in dwarven
+    QString translated_last_name; // last name in human english
+    QString custom_profession; // set by user
+    QString profession; // name of profession set by game
+    int raw_profession; // id of profession set by game
+    bool can_set_labors; // used to prevent cheating
+    int strength;
+    int agility;
+    int toughness;
+    short current_job_id;
+    QString current_job;
+    QString current_sub_job_id;
+    qint8 skill_ratings[MAX_SKILLS]; // -1 for skills the dwarf has never used
+    quint32 skill_exp[MAX_SKILLS];
+    quint64 skill_mask[MAX_SKILLS / 64]; // bit set for every entry in skill_ratings that is used
+    short highest_skill_id; // -1 if the dwarf has no rated skills
+    int total_skill_levels;
+    int legendary_skills; // number of skills at LEGENDARY_RATING or above
+    short traits[TRAIT_COUNT]; // -1 for traits in the average range
+    LaborValues labors; // labors and military preferences by labor id, see MilitaryPreference
+    int squad_ref_id; //Dwarf reference that appears to be used by squad
+    uint turn_count; // Dwarf turn count from start of fortress (as best we know)
+};
+
+#endif // DWARF_DATA_H
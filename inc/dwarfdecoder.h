@@ -0,0 +1,137 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef DWARF_DECODER_H
+#define DWARF_DECODER_H
+
+#include <QtCore>
+#include "dwarfdata.h"
+#include "utils.h"
+
+class DFInstance;
+
+/*! Offsets and settings needed to decode creatures, resolved once per load so
+that the decode stage never has to touch MemoryLayout's string-keyed hashes or
+QSettings (neither of which is safe to hit from worker threads).
+*/
+struct DwarfDecodeContext {
+    DwarfDecodeContext(DFInstance *df);
+
+    // dwarf_offsets
+    uint first_name;
+    uint nick_name;
+    uint last_name;
+    uint custom_profession;
+    uint profession;
+    uint race;
+    uint flags1;
+    uint flags2;
+    uint sex;
+    uint id;
+    uint current_job;
+    uint turn_count;
+    uint states;
+    uint souls;
+    uint labors;
+    uint happiness;
+    uint squad_ref_id;
+    // soul_details
+    uint soul_skills;
+    uint soul_traits;
+    // job_details
+    uint job_id;
+    uint job_sub_job_id;
+    short on_break_value;
+
+    int creature_size; // how many bytes of each creature struct we capture
+    int soul_size;
+    int job_size;
+
+    WORD dwarf_race_id;
+    bool layout_complete;
+    short baby_id;
+    bool use_generic_names;
+    QHash<uint, QString> valid_flags_1;
+    QHash<uint, QString> valid_flags_2;
+    QHash<uint, QString> invalid_flags_1;
+    QHash<uint, QString> invalid_flags_2;
+};
+
+//! raw bytes captured from DF for a single creature, waiting to be decoded
+struct CreatureSnapshot {
+    CreatureSnapshot()
+        : address(0)
+        , first_soul(0)
+        , soul_count(0)
+        , job_address(0)
+    {}
+
+    VIRTADDR address;
+    QByteArray creature; // the creature struct itself
+    QString first_name;
+    QString nick_name;
+    QString custom_profession;
+    VIRTADDR first_soul;
+    int soul_count;
+    QByteArray soul; // the first soul struct
+    QVector<QByteArray> skills; // one raw entry per skill in the first soul
+    VIRTADDR job_address;
+    QByteArray job; // current job struct (empty when idle)
+    QString sub_job_id;
+    QVector<short> states; // only captured when there is no current job
+};
+
+//! a unit of work for the parallel decode stage
+struct DwarfDecodeJob {
+    DwarfDecodeJob() : ctx(0) {}
+    const DwarfDecodeContext *ctx;
+    CreatureSnapshot snapshot;
+    DwarfData data;
+    QStringList warnings; // logged on the GUI thread once decoding finishes
+};
+
+/*! Turns captured creatures into DwarfData records. Capturing is done by
+CreatureGatherer on the thread that owns the DFInstance; everything in here is
+a pure function of the captured bytes and is run in parallel across creatures.
+*/
+class DwarfDecoder {
+    Q_DECLARE_TR_FUNCTIONS(Dwarf)
+public:
+    /*! returns false if the creature in this struct isn't one of our dwarves.
+    reason is set to a human readable explanation when flags rule it out
+    */
+    static bool accept(const QByteArray &creature,
+                       const DwarfDecodeContext &ctx, QString &reason);
+
+    //! build a DwarfData from captured bytes (thread-safe, no remote reads)
+    static void decode(const CreatureSnapshot &snap,
+                       const DwarfDecodeContext &ctx, DwarfData &data,
+                       QStringList &warnings);
+
+    //! QtConcurrent entry point for decode()
+    static void decode_job(DwarfDecodeJob &job);
+
+    //! share d's strings with every other dwarf's (GUI thread, after decoding)
+    static void intern_strings(DwarfData &d);
+};
+
+#endif // DWARF_DECODER_H
@@ -0,0 +1,80 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef DWARF_EXPRESSION_H
+#define DWARF_EXPRESSION_H
+
+#include <QtCore>
+
+class Dwarf;
+
+/*! A small typed expression over a dwarf's stats, for example
+
+    skill(0) >= 10 && labor(0) && !military
+
+Numbers, true/false, the operand names listed by help_text(), comparisons,
+&&, ||, !, + - * / and parentheses all work as they do in C. The text is
+parsed and type checked once into a tree of nodes, so filters, sort keys
+and computed columns can evaluate it for every dwarf without going through
+QtScript. Copies share the same tree.
+*/
+class DwarfExpression {
+public:
+    typedef enum {
+        ET_INVALID,
+        ET_NUMBER,
+        ET_BOOL
+    } EXPRESSION_TYPE;
+
+    class Node; // evaluation tree, see dwarfexpression.cpp
+
+    //! an empty, invalid expression
+    DwarfExpression();
+    //! parse and type check text; check is_valid() and error() afterwards
+    explicit DwarfExpression(const QString &text);
+
+    bool is_valid() const {return m_type != ET_INVALID;}
+    EXPRESSION_TYPE type() const {return m_type;}
+    const QString &text() const {return m_text;}
+    //! why the text didn't compile (empty for valid expressions)
+    const QString &error() const {return m_error;}
+
+    //! value of the expression for one dwarf (true and false are 1 and 0)
+    double value(Dwarf *d) const;
+    //! true if the expression is non-zero for d
+    bool matches(Dwarf *d) const {return value(d) != 0;}
+    /*! values for many dwarves at once. Each node of the tree runs over the
+    whole list before its parent does, rather than walking the tree per dwarf
+    */
+    QVector<double> values(const QList<Dwarf*> &dwarves) const;
+
+    //! HTML reference of the operand names, for help panes
+    static QString help_text();
+
+private:
+    QString m_text;
+    QString m_error;
+    EXPRESSION_TYPE m_type;
+    QSharedPointer<const Node> m_root;
+};
+
+#endif // DWARF_EXPRESSION_H
@@ -0,0 +1,72 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef GAME_DATA_CACHE_H
+#define GAME_DATA_CACHE_H
+
+#include <QtCore>
+
+class DFInstance;
+
+/*! On-disk cache for data we read once per connection that only changes
+when the DF executable or its raws do (language word tables, parsed
+reaction raws). Each section lives in its own file and is tagged with a
+key built from DF's checksum and the newest modification time of the raw
+files, so editing raws or updating DF just causes a cache miss.
+
+Cached sections are mapped into memory (QFile::map) and read straight out
+of the mapping with a QDataStream.
+*/
+class GameDataCache {
+public:
+    //! bump whenever the layout of any cached section changes
+    static const quint32 FORMAT_VERSION = 2;
+
+    GameDataCache(DFInstance *df, const QString &section);
+    ~GameDataCache();
+
+    /*! map the cached section. Returns false if there isn't one, or it was
+    written for a different DF or different raws. On success stream() is
+    positioned at the start of the payload
+    */
+    bool load();
+    QDataStream &stream() {return m_stream;}
+
+    //! replace the cached section with payload (written with a QDataStream)
+    bool save(const QByteArray &payload);
+
+    //! QDataStream version used for cached payloads
+    static int stream_version() {return QDataStream::Qt_4_5;}
+
+private:
+    QString m_key;
+    QFile m_file;
+    uchar *m_map;
+    QBuffer m_buffer;
+    QDataStream m_stream;
+
+    static QString cache_dir();
+    static QString build_key(DFInstance *df);
+    static QDateTime newest_file(const QDir &dir);
+};
+
+#endif // GAME_DATA_CACHE_H
@@ -31,6 +31,7 @@ THE SOFTWARE.
 // forward declaration
 class QSettings;
 #include "labor.h"
+#include "laborset.h"
 class Trait;
 class MilitaryPreference;
 class Profession;
@@ -64,14 +65,24 @@ public:
     int get_xp_for_next_attribute_level(int current_number_of_attributes);
 
     QList<Labor*> get_ordered_labors() {return m_ordered_labors;}
+    //! ids of every labor in game_data.ini
+    const LaborSet &get_labor_ids() const {return m_labor_ids;}
     QHash<int, QString> get_skills() {return m_skills;}
     QList<QPair<int, QString> > get_ordered_skills() {return m_ordered_skills;}
     QHash<int, Trait*> get_traits() {return m_traits;}
     QList<QPair<int, Trait*> > get_ordered_traits() {return m_ordered_traits;}
     QHash<int, MilitaryPreference*> get_military_preferences() {return m_military_preferences;}
+    //! ids of every military preference in game_data.ini (a few are labor ids too)
+    const LaborSet &get_military_preference_ids() const {return m_military_preference_ids;}
     QHash<short, Profession*> get_professions() {return m_professions;}
 
     Labor *get_labor(const int &labor_id);
+    //! skill id used by labor_id or -1 if it doesn't have one (no hash lookup, safe in tight loops)
+    short get_skill_for_labor(int labor_id) const {
+        if (labor_id < 0 || labor_id >= m_labor_skills.size())
+            return -1;
+        return m_labor_skills.at(labor_id);
+    }
     Trait *get_trait(const int &trait_id);
     DwarfJob *get_job(const short &job_id);
     MilitaryPreference *get_military_preference(const int &mil_pref_id);
@@ -96,6 +107,9 @@ public:
     }
 
     void read_raws(QDir df_dir);
+    //! write/read the parsed raws for GameDataCache
+    void save_raws(QDataStream &out);
+    bool load_raws(QDataStream &in);
 
 protected:
     GameDataReader(QObject *parent = 0);
@@ -105,8 +119,11 @@ private:
 
     QHash<int, Labor*> m_labors;
     QList<Labor*> m_ordered_labors;
+    LaborSet m_labor_ids;
+    QVector<short> m_labor_skills; // indexed by labor id
 
     QHash<int, MilitaryPreference*> m_military_preferences;
+    LaborSet m_military_preference_ids;
 
     QHash<int, Trait*> m_traits;
     QList<QPair<int, Trait*> > m_ordered_traits;
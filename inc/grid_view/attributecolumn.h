@@ -39,8 +39,7 @@ public:
     AttributeColumn(QSettings &s, ViewColumnSet *set = 0, QObject *parent = 0);
     AttributeColumn(const AttributeColumn &to_copy); // copy ctor
     AttributeColumn* clone() {return new AttributeColumn(*this);}
-    QStandardItem *build_cell(Dwarf *d);
-    QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+    QVariant cell_data(Dwarf *d, int role);
 
     DWARF_ATTRIBUTE_TYPE attribute() {return m_attribute_type;}
     void set_attribute(DWARF_ATTRIBUTE_TYPE type) {m_attribute_type = type;}
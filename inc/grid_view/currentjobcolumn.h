@@ -32,8 +32,11 @@ public:
     CurrentJobColumn(const QString &title, ViewColumnSet *set = 0, QObject *parent = 0);
     CurrentJobColumn(const CurrentJobColumn &to_copy); // copy ctor
     CurrentJobColumn* clone() {return new CurrentJobColumn(*this);}
-    QStandardItem *build_cell(Dwarf *d);
-    QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+    QVariant cell_data(Dwarf *d, int role);
+
+private:
+    //! resource name of the icon matching the dwarf's current job
+    QString job_pixmap_name(Dwarf *d);
 };
 
 #endif
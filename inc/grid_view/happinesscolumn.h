@@ -31,12 +31,11 @@ public:
 	HappinessColumn(QString title, ViewColumnSet *set = 0, QObject *parent = 0);
     HappinessColumn(const HappinessColumn &to_copy); // copy ctor
     HappinessColumn* clone() {return new HappinessColumn(*this);}
-	QStandardItem *build_cell(Dwarf *d);
-	QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+	QVariant cell_data(Dwarf *d, int role);
+	QVariant aggregate_data(const QString &group_name, const QVector<Dwarf*> &dwarves, int role);
 
 	public slots:
 		void read_settings();
-		void redraw_cells();
 private:
 	QMap<Dwarf::DWARF_HAPPINESS, QColor> m_colors;
 };
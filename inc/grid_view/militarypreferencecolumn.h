@@ -31,8 +31,8 @@ public:
     MilitaryPreferenceColumn(QSettings &s, ViewColumnSet *set = 0, QObject *parent = 0);
     MilitaryPreferenceColumn(const MilitaryPreferenceColumn &to_copy); // copy ctor
     MilitaryPreferenceColumn* clone() {return new MilitaryPreferenceColumn(*this);}
-    QStandardItem *build_cell(Dwarf *d);
-    QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+    QVariant cell_data(Dwarf *d, int role);
+    QVariant aggregate_data(const QString &group_name, const QVector<Dwarf*> &dwarves, int role);
 
     int labor_id() {return m_labor_id;}
     void set_labor_id(int labor_id) {m_labor_id = labor_id;}
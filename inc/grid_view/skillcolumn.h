@@ -31,8 +31,7 @@ public:
     SkillColumn(QSettings &s, ViewColumnSet *set = 0, QObject *parent = 0);
     SkillColumn(const SkillColumn &to_copy); // copy ctor
     SkillColumn* clone() {return new SkillColumn(*this);}
-	QStandardItem *build_cell(Dwarf *d);
-	QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+	QVariant cell_data(Dwarf *d, int role);
 	int skill_id() {return m_skill_id;}
 	void set_skill_id(int skill_id) {m_skill_id = skill_id;}
 
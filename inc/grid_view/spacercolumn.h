@@ -31,8 +31,6 @@ public:
 	SpacerColumn(QSettings &s, ViewColumnSet *set = 0, QObject *parent = 0);
     SpacerColumn(const SpacerColumn &to_copy); //! copy ctor
     SpacerColumn* clone() {return new SpacerColumn(*this);}
-	QStandardItem *build_cell(Dwarf *d);
-	QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
 
 	void set_width(int w) {m_width = w;}
 	int width() {return m_width;}
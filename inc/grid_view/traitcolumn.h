@@ -35,8 +35,7 @@ public:
     TraitColumn(QSettings &s, ViewColumnSet *set = 0, QObject *parent = 0);
     TraitColumn(const TraitColumn &to_copy); // copy ctor
     TraitColumn* clone() {return new TraitColumn(*this);}
-    QStandardItem *build_cell(Dwarf *d);
-    QStandardItem *build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves);
+    QVariant cell_data(Dwarf *d, int role);
     short trait_id() const {return m_trait_id;}
 
     void write_to_ini(QSettings &s) {ViewColumn::write_to_ini(s); s.setValue("trait_id", m_trait_id);}
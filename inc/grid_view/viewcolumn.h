@@ -55,17 +55,18 @@ public:
     void set_viewcolumnset(ViewColumnSet *set) {m_set = set;}
 	virtual COLUMN_TYPE type() {return m_type;}
 
-	QStandardItem *init_cell(Dwarf *d);
-	virtual QStandardItem *build_cell(Dwarf *d) = 0; // create a suitable item based on a dwarf
-	virtual QStandardItem *build_aggregate(const QString &group_name, 
-										   const QVector<Dwarf*> &dwarves) = 0; // create an aggregate cell based on several dwarves
+	//! the background this column's cells use, honoring the color override
+	QColor cell_bg();
+	//! compute the value of a dwarf's cell for a model role; subclasses fall back to this for the shared roles
+	virtual QVariant cell_data(Dwarf *d, int role);
+	//! compute the value of a group's aggregate cell for a model role
+	virtual QVariant aggregate_data(const QString &group_name,
+									const QVector<Dwarf*> &dwarves, int role);
 
 	virtual void write_to_ini(QSettings &s);
 
 	public slots:
 		virtual void read_settings() {}
-		void clear_cells() {m_cells.clear();}
-		virtual void redraw_cells() {}
 
 protected:
 	QString m_title;
@@ -73,7 +74,6 @@ protected:
 	bool m_override_set_colors;
 	ViewColumnSet *m_set;
 	COLUMN_TYPE m_type;
-	QHash<Dwarf*, QStandardItem*> m_cells;
 };
 
 #endif
@@ -114,6 +114,7 @@ private:
         void add_trait_column();
         void add_attribute_column();
         void add_military_preferences_column();
+        void add_expression_column();
 };
 
 #endif
@@ -0,0 +1,178 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef LABOR_SET_H
+#define LABOR_SET_H
+
+#include <QtGlobal>
+#include <string.h>
+
+/*! Fixed size on/off set of labor ids. DF keeps labors in a byte array
+(read as 102 bytes), so 128 bits covers every slot with room to spare.
+*/
+class LaborSet {
+public:
+    static const int MAX_LABORS = 128;
+
+    LaborSet() {
+        clear();
+    }
+
+    void clear() {
+        m_bits[0] = 0;
+        m_bits[1] = 0;
+    }
+
+    bool test(int labor_id) const {
+        if (labor_id < 0 || labor_id >= MAX_LABORS)
+            return false;
+        return (m_bits[labor_id >> 6] >> (labor_id & 63)) & 1;
+    }
+
+    void set(int labor_id, bool enabled = true) {
+        if (labor_id < 0 || labor_id >= MAX_LABORS)
+            return;
+        quint64 mask = Q_UINT64_C(1) << (labor_id & 63);
+        if (enabled)
+            m_bits[labor_id >> 6] |= mask;
+        else
+            m_bits[labor_id >> 6] &= ~mask;
+    }
+
+    //! number of labors in the set
+    int count() const {
+        return popcount(m_bits[0]) + popcount(m_bits[1]);
+    }
+
+    bool is_empty() const {
+        return !(m_bits[0] | m_bits[1]);
+    }
+
+    //! labors in exactly one of the sets (what changed between them)
+    LaborSet operator^(const LaborSet &other) const {
+        LaborSet s;
+        s.m_bits[0] = m_bits[0] ^ other.m_bits[0];
+        s.m_bits[1] = m_bits[1] ^ other.m_bits[1];
+        return s;
+    }
+
+    LaborSet operator&(const LaborSet &other) const {
+        LaborSet s;
+        s.m_bits[0] = m_bits[0] & other.m_bits[0];
+        s.m_bits[1] = m_bits[1] & other.m_bits[1];
+        return s;
+    }
+
+    LaborSet operator|(const LaborSet &other) const {
+        LaborSet s;
+        s.m_bits[0] = m_bits[0] | other.m_bits[0];
+        s.m_bits[1] = m_bits[1] | other.m_bits[1];
+        return s;
+    }
+
+    bool operator==(const LaborSet &other) const {
+        return m_bits[0] == other.m_bits[0] && m_bits[1] == other.m_bits[1];
+    }
+
+    bool operator!=(const LaborSet &other) const {
+        return !(*this == other);
+    }
+
+private:
+    quint64 m_bits[2];
+
+    static int popcount(quint64 bits) {
+#if defined(Q_CC_GNU)
+        return __builtin_popcountll(bits);
+#else
+        bits -= (bits >> 1) & Q_UINT64_C(0x5555555555555555);
+        bits = (bits & Q_UINT64_C(0x3333333333333333)) +
+               ((bits >> 2) & Q_UINT64_C(0x3333333333333333));
+        bits = (bits + (bits >> 4)) & Q_UINT64_C(0x0f0f0f0f0f0f0f0f);
+        return static_cast<int>((bits * Q_UINT64_C(0x0101010101010101)) >> 56);
+#endif
+    }
+};
+
+/*! DF's labor byte array: one byte per id, shared by labors (0 or 1) and
+military preferences (their value). Some ids are both a labor and a
+preference and really are the same byte, so both are kept here together.
+The ids that were read and the ids whose byte is non-zero are kept as
+LaborSets alongside.
+*/
+class LaborValues {
+public:
+    LaborValues() {
+        clear();
+    }
+
+    void clear() {
+        m_ids.clear();
+        m_enabled.clear();
+        memset(m_values, 0, sizeof(m_values));
+    }
+
+    bool contains(int labor_id) const {
+        return m_ids.test(labor_id);
+    }
+
+    quint8 value(int labor_id) const {
+        return contains(labor_id) ? m_values[labor_id] : 0;
+    }
+
+    void set(int labor_id, quint8 value) {
+        if (labor_id < 0 || labor_id >= LaborSet::MAX_LABORS)
+            return;
+        m_ids.set(labor_id);
+        m_enabled.set(labor_id, value > 0);
+        m_values[labor_id] = value;
+    }
+
+    //! ids that hold a byte
+    const LaborSet &ids() const {
+        return m_ids;
+    }
+
+    //! ids whose byte is non-zero (enabled labors)
+    const LaborSet &enabled() const {
+        return m_enabled;
+    }
+
+    //! ids held by only one side or set to different values
+    LaborSet differences(const LaborValues &other) const {
+        LaborSet diff = m_ids ^ other.m_ids;
+        if (memcmp(m_values, other.m_values, sizeof(m_values)) != 0) {
+            for (int i = 0; i < LaborSet::MAX_LABORS; ++i) {
+                if (m_values[i] != other.m_values[i])
+                    diff.set(i);
+            }
+        }
+        return diff;
+    }
+
+private:
+    LaborSet m_ids;
+    LaborSet m_enabled;
+    quint8 m_values[LaborSet::MAX_LABORS]; // 0 for ids not in m_ids
+};
+
+#endif // LABOR_SET_H
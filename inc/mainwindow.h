@@ -135,6 +135,10 @@ private:
 
     void read_settings();
     void write_settings();
+    //! the group by combo boxes, outermost grouping first
+    QList<QComboBox*> group_by_combos() const;
+    //! the groupings picked in the group by combos, outermost first
+    QList<int> group_levels() const;
 
     private slots:
         void set_interface_enabled(bool);
@@ -24,11 +24,13 @@ THE SOFTWARE.
 #define DWARF_MODEL_H
 
 #include <QtGui>
+#include "laborset.h"
 class Dwarf;
 class DFInstance;
 class DwarfModel;
 class GridView;
 class Squad;
+class ViewColumn;
 
 /*
 class CreatureGroup : public QStandardItem {
@@ -47,7 +49,7 @@ private:
 };
 */
 
-class DwarfModel : public QStandardItemModel {
+class DwarfModel : public QAbstractItemModel {
     Q_OBJECT
 public:
     typedef enum {
@@ -82,16 +84,37 @@ public:
     DwarfModel(QObject *parent = 0);
     virtual ~DwarfModel();
     void set_instance(DFInstance *df) {m_df = df;}
-    void set_grid_view(GridView *v) {m_gridview = v;}
+    //! carry the columns of every view in views (each view once, in order)
+    void set_grid_views(const QList<GridView*> &views);
+    //! the sections holding v's columns; false if the rows don't carry v
+    bool view_columns(const GridView *v, int &first, int &count) const;
     void clear_all(); // reset everything to normal
 
-    GROUP_BY current_grouping() const {return m_group_by;}
-    const QMap<QString, QVector<Dwarf*> > *get_dwarf_groups() const {return &m_grouped_dwarves;}
+    //! the outermost grouping, GB_NOTHING when not grouping
+    GROUP_BY current_grouping() const {return m_group_levels.value(0, GB_NOTHING);}
+    //! members of the group whose DR_GROUP_NAME is group_name (empty if there is no such group)
+    QVector<Dwarf*> group_members(const QString &group_name) const;
     Dwarf *get_dwarf_by_id(int id) const {return m_dwarves.value(id, 0);}
 
+    //! member count of the group row at group_idx (counting every nested
+    //! level), and how many members have labor_id enabled or pending a change
+    void group_labor_counts(const QModelIndex &group_idx, int labor_id, int &members,
+                            int &enabled, int &dirty) const;
+
+    //! the dwarf shown on idx's row, or 0 for group rows
+    Dwarf *dwarf_at(const QModelIndex &idx) const;
+    //! the dwarf or group shown on idx's row, stable while rows move around
+    const void *row_owner(const QModelIndex &idx) const;
+
+    //! dwarves with pending changes, in id order
     QVector<Dwarf*> get_dirty_dwarves();
     QList<Dwarf*> get_dwarves() {return m_dwarves.values();}
+    //! announce the pending change count (kept up to date as rows change)
     void calculate_pending();
+    //! hold back row changes until the matching end_changes(), then emit
+    //! every touched row in a few merged ranges; batches can nest
+    void begin_changes();
+    void end_changes();
     int selected_col() const {return m_selected_col;}
     void filter_changed(const QString &);
 
@@ -100,10 +123,21 @@ public:
 
     static bool compare_turn_count(const Dwarf *a, const Dwarf *b);
 
+    // QAbstractItemModel, every role is computed from the dwarves and the
+    // current view's columns when it is asked for
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &idx, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &idx) const;
+
     public slots:
-        void build_row(const QString &key);
         void build_rows();
         void set_group_by(int group_by);
+        //! nest groups: rows are grouped by levels[0], each of those groups by levels[1] and so on
+        void set_group_levels(const QList<int> &levels);
         void load_dwarves();
         void cell_activated(const QModelIndex &idx); // a grid cell was clicked/doubleclicked or enter was pressed on it
         void clear_pending();
@@ -115,12 +149,146 @@ public:
 private:
     DFInstance *m_df;
     QMap<int, Dwarf*> m_dwarves;
-    QMap<QString, QVector<Dwarf*> > m_grouped_dwarves;
     //! squad_leader_id -> squad object
     QHash<int, Squad*> m_squads;
-    GROUP_BY m_group_by;
+    //! groupings asked for, outermost first
+    QList<GROUP_BY> m_group_levels;
     int m_selected_col;
-    GridView *m_gridview;
+    //! views whose columns the rows carry, so that switching between their
+    //! tabs only swaps which sections are shown
+    QList<QPointer<GridView> > m_gridviews;
+    //! view -> (first section, section count) of its columns in m_columns
+    QHash<const GridView*, QPair<int, int> > m_view_columns;
+    //! a dwarf's labor state as the groups it is in have counted it
+    struct LaborTally {
+        LaborSet enabled;
+        LaborSet dirty; //!< labors toggled but not committed
+        LaborSet pref_dirty; //!< military preferences changed but not committed
+        bool operator==(const LaborTally &o) const {
+            return enabled == o.enabled && dirty == o.dirty && pref_dirty == o.pref_dirty;
+        }
+        bool operator!=(const LaborTally &o) const {return !(*this == o);}
+    };
+    //! a group row (or a single dwarf's row when not grouping); groups on
+    //! the innermost level have dwarf rows, the others have subgroups
+    struct DwarfGroup {
+        DwarfGroup()
+            : key(0)
+            , level(0)
+            , parent(0)
+            , enabled_counts(LaborSet::MAX_LABORS, 0)
+            , dirty_counts(LaborSet::MAX_LABORS, 0)
+            , pref_dirty_counts(LaborSet::MAX_LABORS, 0)
+        {}
+        ~DwarfGroup() {qDeleteAll(children);}
+        //! add (sign 1) or take away (sign -1) one member's labor state
+        void count_labors(const LaborTally &t, int sign);
+
+        int key; //!< see group_key()
+        int level; //!< index into m_rows_levels
+        DwarfGroup *parent; //!< 0 on the top level
+        QList<DwarfGroup*> children; //!< subgroups in key order
+        mutable QString label; //!< from group_label(), resolved when first shown
+        mutable QString name; //!< labels of the group and its parents, see group_name()
+        QVector<Dwarf*> members; //!< every dwarf under this group, sorted by id
+        //! labor id -> members with it enabled, kept current by every change
+        QVector<int> enabled_counts;
+        //! labor id -> members with the labor toggled
+        QVector<int> dirty_counts;
+        //! labor id -> members with the military preference changed
+        QVector<int> pref_dirty_counts;
+    };
+    //! dwarf id -> the labor state its groups have counted
+    QHash<int, LaborTally> m_tallies;
+    //! d's labor state as it stands now
+    static LaborTally tally_of(const Dwarf *d);
+    //! top level rows in display order; rows under a group point back at it
+    QList<DwarfGroup*> m_groups;
+    //! true if m_groups was built with group rows (not one row per dwarf)
+    bool m_grouped;
+    //! the groupings m_groups was built with
+    QList<GROUP_BY> m_rows_levels;
+    //! GROUP_BY -> dwarf id -> group key, computed once per refresh for each mode used
+    QHash<int, QHash<int, int> > m_group_keys;
+    //! profession, job and squad names that group keys stand for, indexed by key
+    QStringList m_labels;
+    QHash<QString, int> m_label_ids;
+    //! the grid's columns after the name column, flattened from the views' sets
+    QVector<QPointer<ViewColumn> > m_columns;
+    //! nesting depth of begin_changes()
+    int m_batch_depth;
+    //! rows touched by the open batch; dwarves know their own rows
+    QSet<Dwarf*> m_changed_dwarves;
+    QList<QPersistentModelIndex> m_changed_groups;
+    //! dwarf id -> pending changes (dirty dwarves only), and their sum
+    QHash<int, int> m_pending_counts;
+    int m_pending_total;
+    QIcon m_icn_male;
+    QIcon m_icn_female;
+    //! the last few tooltips shown, keyed by dwarf (or group) and column
+    mutable QCache<QPair<const void*, int>, QString> m_tooltips;
+    static const int TOOLTIP_CACHE_SIZE = 16;
+
+    //! true if idx is the header row of a group
+    bool is_group(const QModelIndex &idx) const;
+    //! the group whose header row is idx, or 0 for dwarf rows
+    DwarfGroup *group_at(const QModelIndex &idx) const;
+    //! index of g's header row
+    QModelIndex group_index(const DwarfGroup *g) const;
+    //! the grouping of rows on a level
+    GROUP_BY mode_at(int level) const {return m_rows_levels.value(level, GB_NOTHING);}
+    //! true if g's rows are dwarves rather than subgroups
+    bool is_leaf(const DwarfGroup *g) const {return g->level >= m_rows_levels.size() - 1;}
+    //! compute a role for a cell without going through the tooltip cache
+    QVariant cell_value(const QModelIndex &idx, int role) const;
+    QVariant name_data(Dwarf *d, int role) const;
+    QVariant group_data(const DwarfGroup *g, int role) const;
+    //! small integer id of the group d falls in under mode
+    int group_key(Dwarf *d, GROUP_BY mode);
+    //! interned id for a group label
+    int label_id(const QString &label);
+    //! every dwarf's group key under mode, computed if it isn't cached
+    const QHash<int, int> &group_keys(GROUP_BY mode);
+    //! display name of a group on its own level
+    const QString &group_label(const DwarfGroup *g) const;
+    //! labels of g and its parents, outermost first; unique across the tree
+    const QString &group_name(const DwarfGroup *g) const;
+    //! the group named group_name by group_name(), or 0
+    DwarfGroup *find_group(const QString &group_name,
+                           const QList<DwarfGroup*> &groups) const;
+    //! bucket dwarves (sorted by id) by their keys under mode with a counting sort
+    void partition(const QVector<Dwarf*> &dwarves, GROUP_BY mode,
+                   QVector<int> &keys, QVector<QVector<Dwarf*> > &buckets);
+    //! build the groups for level from dwarves, recursing into the deeper levels
+    void build_groups(QList<DwarfGroup*> &out, DwarfGroup *parent, int level,
+                      const QVector<Dwarf*> &dwarves);
+    //! point every dwarf under g (whose header row is g_idx) at its row
+    void index_members(DwarfGroup *g, const QModelIndex &g_idx);
+    //! forget the keys of groupings that pending (uncommitted) changes can affect
+    void forget_pending_group_keys();
+    //! move d to the group its pending changes put it in, touching only the
+    //! rows on its old and new paths
+    void regroup(Dwarf *d);
+    //! drop every row, telling attached views to start over
+    void reset_rows();
+    //! bring parent's subgroups in line with a freshly built set, emitting
+    //! only the row changes; takes ownership of fresh
+    void merge_groups(DwarfGroup *parent, const QModelIndex &parent_idx,
+                      QList<DwarfGroup*> fresh);
+    //! merge an innermost group's new member list into its dwarf rows
+    void update_members(DwarfGroup *g, const QModelIndex &g_idx,
+                        const QVector<Dwarf*> &members);
+    //! emit dataChanged for every column of a row (when the batch ends)
+    void row_changed(int row, const QModelIndex &parent = QModelIndex());
+    //! emit dataChanged for a group's row, every row under it and its parents' rows
+    void group_changed(const QModelIndex &g_idx);
+    //! refresh d's share of m_pending_total
+    void update_pending_count(Dwarf *d);
+    //! move d's changed labors into the counts of the groups it is in
+    void update_labor_counts(Dwarf *d);
+
+    private slots:
+        void clear_tooltips();
 
 signals:
     void new_pending_changes(int);
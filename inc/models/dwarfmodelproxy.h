@@ -24,7 +24,12 @@ THE SOFTWARE.
 #define DWARF_MODEL_PROXY_H
 
 #include <QtGui>
+#if QT_VERSION >= 0x040700
+#include <QScriptProgram>
+#endif
+#include "dwarfexpression.h"
 
+class Dwarf;
 class DwarfModel;
 class QScriptEngine;
 
@@ -42,19 +47,99 @@ public:
 	DwarfModelProxy(QObject *parent = 0);
 	DwarfModel* get_dwarf_model() const;
 	void sort(int column, Qt::SortOrder order);
+	void setSourceModel(QAbstractItemModel *model);
 	public slots:
 		void cell_activated(const QModelIndex &idx);
 		void setFilterFixedString(const QString &pattern);
 		void sort(int, DwarfModelProxy::DWARF_SORT_ROLE);
         void apply_script(const QString &script_body);
+        //! order dwarves by the value of a DwarfExpression (ties go by name)
+        void sort_by_expression(const QString &expression, Qt::SortOrder order);
+        //! sort by column as well, after the current keys (or flip it if it's already one)
+        void add_sort_column(int column);
+        //! pick up option changes (like hiding children) that affect the filter
+        void read_settings();
 
 protected:
 	bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
 	bool filterAcceptsColumn(int source_column, const QModelIndex &source_parent) const;
+	bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
 private:
 	QString m_filter_text;
     QScriptEngine *m_engine;
     QString m_active_filter_script;
+    //! the filter script, when it is a plain DwarfExpression that needs no QtScript
+    DwarfExpression m_filter_expression;
+    //! expression set by sort_by_expression(), invalid for the normal sorts
+    DwarfExpression m_sort_expression;
+    //! m_sort_expression's value per dwarf, computed for all dwarves at once
+    mutable QHash<const Dwarf*, double> m_sort_keys;
+
+    //! one column of a (possibly multi-column) sort
+    struct SortColumn {
+        SortColumn(int c, int r, Qt::SortOrder o) : column(c), role(r), order(o) {}
+        int column;
+        int role;
+        Qt::SortOrder order;
+    };
+    //! sort columns in priority order; the first is what the header shows
+    QList<SortColumn> m_sort_chain;
+    //! direction of the primary key, which QSortFilterProxyModel applies to all of them
+    Qt::SortOrder m_sort_order;
+
+    //! a precomputed comparison key, numbers before strings
+    struct SortKey {
+        bool is_text;
+        double value; //!< the number, or the string's collation rank
+        bool operator==(const SortKey &o) const {return is_text == o.is_text && value == o.value;}
+        bool operator<(const SortKey &o) const {
+            return is_text != o.is_text ? !is_text : value < o.value;
+        }
+    };
+    //! a source row by the dwarf or group on it, so keys survive rows moving
+    typedef const void *RowId;
+    //! (column, role) -> key for every source row, built once per refresh
+    mutable QHash<QPair<int, int>, QHash<RowId, SortKey> > m_column_keys;
+
+    //! the filter settings in effect, gathered once per filter change instead of once per row
+    struct FilterPredicate {
+        bool hide_children;
+        short baby_id;
+        short child_id;
+        QString text; //!< lowercased filter text
+    } m_predicate;
+    //! lowercased display names, filled in as rows are filtered
+    mutable QHash<const Dwarf*, QString> m_lower_names;
+
+    //! script results by dwarf id, filled for every dwarf at once when stale
+    mutable QBitArray m_script_done;
+    mutable QBitArray m_script_accepted;
+    mutable bool m_script_stale;
+#if QT_VERSION >= 0x040700
+    //! the active filter script, parsed once
+    QScriptProgram m_script_program;
+#endif
+
+    //! rebuild m_predicate from the current settings and filter text
+    void compile_filter();
+    bool accepts_dwarf(Dwarf *d) const;
+    //! the active script's cached verdict on a dwarf
+    bool script_accepts(Dwarf *d) const;
+    //! run the active script against one dwarf and remember the result
+    void record_script_result(Dwarf *d) const;
+    //! m_sort_expression's value for d
+    double sort_key(Dwarf *d) const;
+    //! fill m_column_keys for a column, ranking strings by locale collation once
+    void build_column_keys(int column, int role) const;
+    SortKey column_key(const QModelIndex &idx, const SortColumn &sc) const;
+
+    private slots:
+        void clear_name_index();
+        //! every dwarf changed, so scripts must run again on the next filter pass
+        void script_results_stale();
+        //! forget the script results of the dwarves on the changed rows
+        void forget_script_results(const QModelIndex &top_left, const QModelIndex &bottom_right);
+        void clear_sort_keys();
 };
 
 #endif
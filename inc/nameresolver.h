@@ -0,0 +1,82 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef NAME_RESOLVER_H
+#define NAME_RESOLVER_H
+
+#include <QtCore>
+#include "utils.h"
+
+class DFInstance;
+
+/*! Turns DF's language names (7 word ids) into text. The same family and
+squad names come up over and over, so assembled names are remembered by
+their word ids and the language they were assembled for. Safe to call from
+the decode worker threads. Call clear() whenever the language tables are
+reloaded.
+*/
+class NameResolver {
+public:
+    enum {
+        NAME_WORDS = 7,
+        NAME_BYTES = NAME_WORDS * 4
+    };
+
+    typedef enum {
+        NL_DWARF = 0, // creature last name in dwarven
+        NL_GENERIC, // creature last name in english
+        NL_TRANSLATED // "The Something of Something" style (squads, etc)
+    } NAME_LANGUAGE;
+
+    /*! creature last name built from the NAME_WORDS word ids found in buf at
+    offset (NL_DWARF or NL_GENERIC)
+    */
+    static QString last_name(const QByteArray &buf, uint offset,
+                             NAME_LANGUAGE language);
+
+    //! "The ..." style name stored at addr, fetched with a single read
+    static QString read_translated_name(DFInstance *df, const VIRTADDR &addr);
+    //! "The ..." style name whose word ids were copied into buf at offset
+    static QString translated_name(const QByteArray &buf, uint offset);
+
+    //! forget every cached name
+    static void clear();
+
+private:
+    struct NameKey {
+        quint32 words[NAME_WORDS];
+        int language;
+        bool operator==(const NameKey &other) const;
+    };
+    friend uint qHash(const NameKey &key);
+
+    static QMutex s_mutex;
+    static QHash<NameKey, QString> s_names;
+
+    static NameKey make_key(const QByteArray &buf, uint offset,
+                            NAME_LANGUAGE language);
+    static QString assemble_last_name(const NameKey &key);
+    static QString assemble_translated_name(const NameKey &key);
+    static QString lookup(const NameKey &key);
+};
+
+#endif // NAME_RESOLVER_H
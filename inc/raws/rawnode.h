@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <QObject>
 #include <QVector>
 #include <QSharedPointer>
+#include <QDataStream>
 
 class RawNode;
 typedef QSharedPointer<RawNode> RawNodePtr;
@@ -81,6 +82,26 @@ public:
         return result;
     }
 
+    //! write this node and its children (see GameDataCache)
+    void save(QDataStream &out) const {
+        out << name << values << (qint32)children.size();
+        foreach(RawNodePtr n, children) {
+            n->save(out);
+        }
+    }
+
+    //! read back a node written by save()
+    void load(QDataStream &in) {
+        qint32 count = 0;
+        in >> name >> values >> count;
+        children.clear();
+        for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            RawNodePtr n(new RawNode);
+            n->load(in);
+            children.append(n);
+        }
+    }
+
 protected:
     QString name;
     QVector<QString> values;
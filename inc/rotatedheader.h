@@ -48,20 +48,33 @@ protected:
     void leaveEvent(QEvent *e);
     void mouseMoveEvent(QMouseEvent *e);
     void mousePressEvent(QMouseEvent *e);
+    void mouseReleaseEvent(QMouseEvent *e);
 
 signals:
     void section_right_clicked(int idx);
     void sort(int, DwarfModelProxy::DWARF_SORT_ROLE);
+    void sort_by_expression(const QString &expression, Qt::SortOrder order);
+    //! shift+click, sort by this column too
+    void add_sort_column(int idx);
 
 private:
     QPoint m_p;
     QList<int> m_spacer_indexes;
     bool m_shade_column_headers;
     int m_hovered_column;
+    QFont m_label_font;
+    QString m_sort_expression; //!< last expression sorted by, offered again next time
+    //! rotated column titles, cleared when settings change
+    mutable QHash<QString, QPixmap> m_labels;
+
+    //! the rotated label for a section of the given size
+    QPixmap label_pixmap(const QString &text, const QSize &size) const;
 
     private slots:
         //! called by a sorting context menu action
         void sort_action();
+        //! ask for an expression to sort dwarves by
+        void sort_by_expression_action();
         //! called by context menu on sections
         void toggle_set_action();
 };
@@ -27,33 +27,53 @@ THE SOFTWARE.
 #include <QStringList>
 #include "gamedatareader.h"
 
+/*! Plain value type (no heap members) so skills can be stored in packed
+arrays and copied around freely. The name is looked up from the skill id
+only when it is displayed.
+*/
 class Skill
 {
 public:
-    Skill();
-    Skill(short id, uint exp, short rating);
+    enum {MAX_RATING = 20}; // DF caps skill levels here
+
+    Skill()
+        : m_id(-1)
+        , m_rating(-1)
+        , m_exp(0)
+    {}
+    Skill(short id, uint exp, short rating)
+        : m_id(id)
+        , m_rating(rating > MAX_RATING ? MAX_RATING : rating)
+        , m_exp(exp)
+    {}
 
     short id() const {return m_id;}
     short rating() const {return m_rating;}
     uint exp() const {return m_exp;}
-    uint actual_exp() const {return m_actual_exp;}
-    uint exp_for_current_level() const {return m_exp_for_current_level;}
-    uint exp_for_next_level() const {return m_exp_for_next_level;}
+    uint actual_exp() const {return m_exp + exp_for_current_level();}
+    uint exp_for_current_level() const {return exp_for_level(m_rating);}
+    uint exp_for_next_level() const {return exp_for_level(m_rating + 1);}
     QString exp_summary() const;
 
     QString to_string(bool include_level = true, bool include_exp_summary = true) const;
     //QString name() {return QString("(%1) %2").arg(m_id).arg(m_name);}
-    QString name() {return m_name;}
-    bool operator<(const Skill &s2) const;
+    QString name() const;
+    bool operator<(const Skill &s2) const {return m_rating < s2.m_rating;}
+
+    //! total xp needed to reach level from nothing
+    static uint exp_for_level(int level) {
+        if (level <= 0)
+            return 0;
+        return level > MAX_RATING + 1 ? LEVEL_XP[MAX_RATING + 1] : LEVEL_XP[level];
+    }
 
 private:
+    static const uint LEVEL_XP[MAX_RATING + 2];
+
     short m_id;
-    uint m_exp;
-    uint m_actual_exp;
-    uint m_exp_for_current_level;
-    uint m_exp_for_next_level;
     short m_rating;
-    QString m_name;
+    uint m_exp; // xp towards the next level
 };
+Q_DECLARE_TYPEINFO(Skill, Q_PRIMITIVE_TYPE);
 
 #endif // SKILL_H
@@ -27,24 +27,28 @@ THE SOFTWARE.
 #include "utils.h"
 
 class Dwarf;
-class Word;
 class DFInstance;
 class MemoryLayout;
 
 class Squad : public QObject {
     Q_OBJECT
 public:
-    Squad(DFInstance *df, VIRTADDR address, QObject *parent = 0);
+    //! squads are read in bulk by DFInstance::load_squads()
+    Squad(DFInstance *df, VIRTADDR address, int id, const QString &name,
+          QObject *parent = 0);
     virtual ~Squad();
 
-    static Squad* get_squad(DFInstance *df, const VIRTADDR &address);
-
     //! Return the memory address (in hex) of this creature in the remote DF process
     VIRTADDR address() {return m_address;}
     int id() {return m_id;}
     QString name() {return m_name;}
     QVector<Dwarf *> members() {return m_members;}
-    void refresh_data();
+
+    /*! look up each member's ref id (-1 for an empty slot) in
+    dwarves_by_ref_id, which is keyed on Dwarf::get_squad_ref_id()
+    */
+    void set_members(const QVector<int> &ref_ids,
+                     const QHash<int, Dwarf*> &dwarves_by_ref_id);
 
 private:
     VIRTADDR m_address;
@@ -53,13 +57,6 @@ private:
     DFInstance * m_df;
     MemoryLayout * m_mem;
     QVector<Dwarf *> m_members;
-
-    void read_id();
-    void read_name();
-    void read_members();
-
-    Word * read_word(uint offset);
-    QString read_chunked_name();
 };
 
 #endif
@@ -40,6 +40,9 @@ public:
     ~StateTableView();
 
     void set_model(DwarfModel *model, DwarfModelProxy *proxy);
+    //! show the name column and count sections from first, hiding the
+    //! columns the model carries for other tabs
+    void show_columns(int first, int count);
     UberDelegate *get_delegate() {return m_delegate;}
     RotatedHeader *get_header() {return m_header;}
 
@@ -74,13 +77,18 @@ private:
     UberDelegate *m_delegate;
     RotatedHeader *m_header;
     int m_grid_size;
-    QList<int> m_expanded_rows;
+    //! names of the groups the user has expanded, so they survive a rebuild
+    QStringList m_expanded_groups;
     bool m_auto_expand_groups;
     bool m_single_click_labor_changes;
     //! we have to store this ourselves since the click(), accept() etc... don't send which button caused them
     Qt::MouseButton m_last_button;
     bool m_column_already_sorted;
 
+    //! the dwarves on the selected rows, gathered before any of them can
+    //! change groups (and rows)
+    QList<Dwarf*> selected_dwarves() const;
+
     private slots:
         void set_nickname();
         void new_custom_profession();
@@ -0,0 +1,45 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <QtCore>
+
+/*! Interns strings read from DF. Dwarves share a handful of last names,
+professions and job descriptions, so instead of every record holding its own
+copy they all hold implicitly shared copies of one pooled string. Only used
+from the GUI thread, once the decode workers are done.
+*/
+class StringPool {
+public:
+    //! return a copy of str that shares its data with every other interned copy
+    static QString intern(const QString &str);
+
+    //! drop everything pooled so far (strings still in use stay valid)
+    static void clear();
+
+private:
+    static QSet<QString> s_strings;
+};
+
+#endif // STRING_POOL_H
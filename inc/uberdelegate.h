@@ -78,16 +78,24 @@ private:
     QPolygonF m_star_shape;
     QPolygonF m_diamond_shape;
     SKILL_DRAWING_METHOD m_skill_drawing_method;
+    //! pre-rendered skill and labor cells, see paint_glyph()
+    mutable QHash<quint64, QPixmap> m_glyphs;
+    static const int MAX_CACHED_GLYPHS = 2048;
 
     void paint_cell(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
 
-    void paint_grid(const QRect &adjusted, bool dirty, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
+    void paint_grid(const QRect &adjusted, bool dirty, QPainter *p, const QStyleOptionViewItem &opt) const;
 
     //! return the bg color that was painted
     QColor paint_bg(const QRect &adjusted, bool active, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
+    QColor fill_bg(const QRect &adjusted, bool active, QColor bg, QPainter *p, const QStyleOptionViewItem &opt) const;
 
-    void paint_skill(const QRect &adjusted, int rating, QColor bg, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
-    void paint_labor(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
+    //! draw a whole skill or labor cell (bg, skill shape, grid) from a cached pixmap
+    void paint_glyph(short rating, bool active, bool dirty, const QColor &bg, QPainter *p, const QStyleOptionViewItem &opt) const;
+
+    void paint_skill(const QRect &adjusted, int rating, QColor bg, QPainter *p, const QStyleOptionViewItem &opt) const;
+    //! labor cells fill the whole cell from the glyph cache, so take no rect
+    void paint_labor(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
     void paint_pref(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
     void paint_aggregate(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const;
 
@@ -86,6 +86,15 @@ static inline short decode_short(const QByteArray &arr) {
     return *out_ptr;
 }
 
+//! copy a T out of buf at offset, 0 if the offset is unknown (-1) or too large
+template <typename T>
+static inline T peek(const QByteArray &buf, uint offset) {
+    T out = 0;
+    if (offset != 0xFFFFFFFF && offset + sizeof(T) <= (uint)buf.size())
+        memcpy(&out, buf.constData() + offset, sizeof(T));
+    return out;
+}
+
 static inline QByteArray encode_skillpattern(short skill, short exp, short rating) {
     QByteArray bytes;
     bytes.reserve(6);
@@ -54,6 +54,7 @@ public:
 		void draw_views();
 		void write_tab_order();
 		void set_group_by(int group_by);
+		void set_group_levels(const QList<int> &levels);
 		void redraw_current_tab();
 
 		GridView *get_view(const QString &name);
@@ -75,6 +76,11 @@ private:
     QList<Dwarf*> m_selected_dwarfs;
 
     StateTableView *get_stv(int idx = -1);
+    //! have the model carry the columns of every view that has a tab open
+    void project_open_views();
+    //! show tab idx, rebuilding the rows first if rebuild is set (or if the
+    //! model doesn't carry the tab's columns yet)
+    void show_tab(int idx, bool rebuild);
 
 	private slots:
 		//! used when adding tabs via the tool button
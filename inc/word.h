@@ -37,6 +37,12 @@ public:
     virtual ~Word();
 
     static Word* get_word(DFInstance *df, const VIRTADDR &address);
+    //! load a whole table of words with two batched reads (see DFInstance::read_struct_strings())
+    static QVector<Word*> get_words(DFInstance *df, const QVector<VIRTADDR> &addresses);
+    //! write/read a word for GameDataCache; the address belongs to the DF
+    //! process it was read from, so it isn't kept and loaded words can't refresh
+    void save(QDataStream &out);
+    static Word* load(DFInstance *df, QDataStream &in);
 
     //! Return the memory address (in hex) of this creature in the remote DF process
     VIRTADDR address() {return m_address;}
@@ -68,7 +74,12 @@ private:
     DFInstance * m_df;
     MemoryLayout * m_mem;
 
+    Word(DFInstance *df, VIRTADDR address, const QVector<QString> &members,
+         int first, QObject *parent = 0);
     void read_members();
+    //! offsets of every string member, in the order set_members() expects
+    static QVector<uint> member_offsets(MemoryLayout *mem);
+    void set_members(const QVector<QString> &members, int first);
 };
 
 #endif
@@ -0,0 +1,151 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "creaturegatherer.h"
+#include "memorylayout.h"
+#include "utils.h"
+
+CreatureGatherer::CreatureGatherer(DFInstance *df,
+                                   const DwarfDecodeContext &ctx)
+    : m_df(df)
+    , m_ctx(ctx)
+{}
+
+QVector<CreatureSnapshot> CreatureGatherer::gather_creatures(
+        const QVector<VIRTADDR> &addrs) {
+    QVector<ScatterRead> reads;
+    reads.reserve(addrs.size());
+    foreach(VIRTADDR addr, addrs) {
+        reads << ScatterRead(addr, m_ctx.creature_size);
+    }
+    m_df->read_raw_batch(reads);
+
+    QVector<CreatureSnapshot> snaps(addrs.size());
+    for (int i = 0; i < addrs.size(); ++i) {
+        snaps[i].address = addrs.at(i);
+        snaps[i].creature = reads.at(i).data;
+    }
+    return snaps;
+}
+
+void CreatureGatherer::gather_details(QVector<CreatureSnapshot> &snaps) {
+    int n = snaps.size();
+    m_df->attach();
+
+    // level 1: everything hanging directly off the creature struct
+    QVector<ScatterRead> soul_vectors(n), jobs(n), state_vectors(n);
+    QVector<VIRTADDR> string_addrs;
+    QVector<QString*> string_targets;
+    for (int i = 0; i < n; ++i) {
+        CreatureSnapshot &s = snaps[i];
+        string_addrs << s.address + m_ctx.first_name
+                << s.address + m_ctx.nick_name
+                << s.address + m_ctx.custom_profession;
+        string_targets << &s.first_name << &s.nick_name
+                << &s.custom_profession;
+
+        soul_vectors[i] = m_df->vector_body(s.creature, m_ctx.souls);
+        s.job_address = peek<VIRTADDR>(s.creature, m_ctx.current_job);
+        if (s.job_address) {
+            jobs[i] = ScatterRead(s.job_address, m_ctx.job_size);
+            if (m_ctx.job_sub_job_id != 0xFFFFFFFF) {
+                string_addrs << s.job_address + m_ctx.job_sub_job_id;
+                string_targets << &s.sub_job_id;
+            }
+        } else if (m_ctx.states) {
+            state_vectors[i] = m_df->vector_body(s.creature, m_ctx.states);
+        }
+    }
+    read_level(QList<QVector<ScatterRead>*>() << &soul_vectors << &jobs
+               << &state_vectors);
+    QVector<QString> strings = m_df->read_strings(string_addrs);
+    for (int i = 0; i < strings.size(); ++i) {
+        *string_targets[i] = strings.at(i);
+    }
+
+    // level 2: first soul and state entries
+    QVector<ScatterRead> souls(n);
+    QVector<ScatterRead> state_entries;
+    QVector<int> state_owners;
+    for (int i = 0; i < n; ++i) {
+        CreatureSnapshot &s = snaps[i];
+        s.job = jobs.at(i).data;
+        QVector<VIRTADDR> soul_ptrs = m_df->vector_pointers(soul_vectors.at(i).data);
+        s.soul_count = soul_ptrs.size();
+        if (s.soul_count == 1) {
+            s.first_soul = soul_ptrs.at(0);
+            souls[i] = ScatterRead(s.first_soul, m_ctx.soul_size);
+        }
+        foreach(VIRTADDR entry, m_df->vector_pointers(state_vectors.at(i).data)) {
+            state_entries << ScatterRead(entry, sizeof(short));
+            state_owners << i;
+        }
+    }
+    read_level(QList<QVector<ScatterRead>*>() << &souls << &state_entries);
+    for (int i = 0; i < state_entries.size(); ++i) {
+        snaps[state_owners.at(i)].states <<
+                peek<qint16>(state_entries.at(i).data, 0);
+    }
+
+    // level 3: skill vectors
+    QVector<ScatterRead> skill_vectors(n);
+    for (int i = 0; i < n; ++i) {
+        CreatureSnapshot &s = snaps[i];
+        s.soul = souls.at(i).data;
+        if (!s.soul.isEmpty())
+            skill_vectors[i] = m_df->vector_body(s.soul, m_ctx.soul_skills);
+    }
+    read_level(QList<QVector<ScatterRead>*>() << &skill_vectors);
+
+    // level 4: skill entries (type, level, experience, last used counter,
+    // rust, rust counter, demotion counter)
+    QVector<ScatterRead> skills;
+    QVector<int> skill_owners;
+    for (int i = 0; i < n; ++i) {
+        foreach(VIRTADDR entry, m_df->vector_pointers(skill_vectors.at(i).data)) {
+            skills << ScatterRead(entry, 0x1C);
+            skill_owners << i;
+        }
+    }
+    read_level(QList<QVector<ScatterRead>*>() << &skills);
+    for (int i = 0; i < skills.size(); ++i) {
+        if (!skills.at(i).data.isEmpty())
+            snaps[skill_owners.at(i)].skills << skills.at(i).data;
+    }
+
+    m_df->detach();
+}
+
+void CreatureGatherer::read_level(
+        const QList<QVector<ScatterRead>*> &groups) {
+    QVector<ScatterRead> all;
+    foreach(QVector<ScatterRead> *group, groups) {
+        all += *group;
+    }
+    m_df->read_raw_batch(all);
+    int pos = 0;
+    foreach(QVector<ScatterRead> *group, groups) {
+        for (int i = 0; i < group->size(); ++i) {
+            (*group)[i] = all.at(pos++);
+        }
+    }
+}
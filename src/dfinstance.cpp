@@ -23,9 +23,13 @@ THE SOFTWARE.
 
 #include <QtGui>
 #include <QtDebug>
+#include <QtConcurrentMap>
 #include "defines.h"
 #include "dfinstance.h"
 #include "dwarf.h"
+#include "dwarfdecoder.h"
+#include "stringpool.h"
+#include "creaturegatherer.h"
 #include "squad.h"
 #include "word.h"
 #include "utils.h"
@@ -34,6 +38,8 @@ THE SOFTWARE.
 #include "cp437codec.h"
 #include "dwarftherapist.h"
 #include "memorysegment.h"
+#include "gamedatacache.h"
+#include "nameresolver.h"
 #include "truncatingfilelogger.h"
 #include "mainwindow.h"
 
@@ -161,6 +167,217 @@ qint32 DFInstance::read_int(const VIRTADDR &addr) {
     return decode_int(out);
 }
 
+void DFInstance::read_raw_batch(QVector<ScatterRead> &reads) {
+    // blocks closer together than this get fetched with a single read
+    const VIRTADDR max_gap = 0x400;
+    const VIRTADDR max_span = 0x10000;
+
+    QList<QPair<VIRTADDR, int> > order;
+    for (int i = 0; i < reads.size(); ++i) {
+        reads[i].data.clear();
+        if (reads.at(i).bytes > 0)
+            order << qMakePair(reads.at(i).addr, i);
+    }
+    qSort(order);
+
+    attach();
+    int i = 0;
+    while (i < order.size()) {
+        VIRTADDR span_start = order.at(i).first;
+        VIRTADDR span_end = span_start + reads.at(order.at(i).second).bytes;
+        int j = i + 1;
+        for (; j < order.size(); ++j) {
+            const ScatterRead &next = reads.at(order.at(j).second);
+            if (next.addr > span_end + max_gap ||
+                next.addr + next.bytes - span_start > max_span)
+                break;
+            span_end = qMax(span_end, next.addr + next.bytes);
+        }
+
+        QByteArray span;
+        int bytes_read = read_raw(span_start, span_end - span_start, span);
+        for (int k = i; k < j; ++k) {
+            ScatterRead &r = reads[order.at(k).second];
+            int offset = r.addr - span_start;
+            if (offset + r.bytes <= bytes_read) {
+                r.data = span.mid(offset, r.bytes);
+            } else {
+                // the merged span crossed something unreadable, so fall back
+                // to reading this block on its own
+                QByteArray single;
+                if (read_raw(r.addr, r.bytes, single) == r.bytes)
+                    r.data = single;
+            }
+        }
+        i = j;
+    }
+    detach();
+}
+
+DFInstance::ScatterRead DFInstance::vector_body(const QByteArray &buf,
+                                               uint offset) {
+    if (offset == 0xFFFFFFFF)
+        return ScatterRead();
+    offset += VECTOR_POINTER_OFFSET;
+    VIRTADDR start = peek<VIRTADDR>(buf, offset);
+    VIRTADDR end = peek<VIRTADDR>(buf, offset + 4);
+    if (!start || end < start || (end - start) % 4 ||
+        (end - start) / 4 > 5000) {
+        // not something that looks like a sane vector
+        return ScatterRead();
+    }
+    return ScatterRead(start, end - start);
+}
+
+QVector<VIRTADDR> DFInstance::vector_pointers(const QByteArray &body) {
+    QVector<VIRTADDR> addrs;
+    bool check = m_layout->is_complete();
+    for (int i = 0; i + 4 <= body.size(); i += 4) {
+        VIRTADDR addr = peek<VIRTADDR>(body, i);
+        if (!check || is_valid_address(addr))
+            addrs << addr;
+    }
+    return addrs;
+}
+
+QVector<QString> DFInstance::read_strings(const QVector<VIRTADDR> &addrs) {
+    return read_struct_strings(addrs, QVector<uint>() << 0);
+}
+
+QString DFInstance::read_std_string(const VIRTADDR &addr) {
+    return read_strings(QVector<VIRTADDR>() << addr).at(0);
+}
+
+int DFInstance::string_header_size() {
+    MemoryLayout *mem = memory_layout();
+    uint last = qMax(mem->string_buffer_offset(),
+                     qMax(mem->string_length_offset(),
+                          mem->string_cap_offset()));
+    return last + sizeof(VIRTADDR);
+}
+
+DFInstance::StringLocation DFInstance::locate_string(
+        const QByteArray &data, uint offset, const VIRTADDR &header_addr) {
+    StringLocation loc;
+#ifdef Q_WS_WIN
+    // MSVC std::string: short strings live inside the header itself
+    MemoryLayout *mem = memory_layout();
+    int len = peek<qint32>(data, offset + mem->string_length_offset());
+    int cap = peek<qint32>(data, offset + mem->string_cap_offset());
+    if (len > cap || len < 0 || len > 1024)
+        return loc; // probably not really a string
+    loc.len = len;
+    loc.buffer = header_addr + offset + mem->string_buffer_offset();
+    if (cap >= 16)
+        loc.buffer = peek<VIRTADDR>(data, offset + mem->string_buffer_offset());
+#else
+    // gcc std::string is just a pointer to the characters, the length is kept
+    // in a small header (STRING_REP_SIZE bytes) right in front of them
+    Q_UNUSED(header_addr);
+    loc.buffer = peek<VIRTADDR>(data, offset);
+    loc.len = -1;
+#endif
+    return loc;
+}
+
+QVector<QString> DFInstance::read_struct_strings(
+        const QVector<VIRTADDR> &structs, const QVector<uint> &offsets) {
+    // when the length lives next to the characters, guess this many to
+    // avoid a third round trip for the (common) short strings
+    const int short_string_guess = 64;
+    const int max_len = 1024;
+    const uint missing = 0xFFFFFFFF;
+
+    QVector<QString> strings(structs.size() * offsets.size());
+    uint struct_size = 0;
+    foreach(uint offset, offsets) {
+        if (offset != missing)
+            struct_size = qMax(struct_size, offset + string_header_size());
+    }
+    if (!struct_size)
+        return strings;
+
+    attach();
+    // pass 1: every struct that holds strings
+    QVector<ScatterRead> headers;
+    headers.reserve(structs.size());
+    foreach(VIRTADDR addr, structs) {
+        headers << ScatterRead(addr, struct_size);
+    }
+    read_raw_batch(headers);
+
+    // pass 2: every character buffer that isn't already inside a header
+    QVector<ScatterRead> bodies;
+    QVector<bool> has_rep; // body starts with the STRING_REP_SIZE header
+    QVector<int> body_index(strings.size(), -1);
+    for (int i = 0; i < headers.size(); ++i) {
+        const ScatterRead &h = headers.at(i);
+        if (h.data.isEmpty())
+            continue;
+        for (int j = 0; j < offsets.size(); ++j) {
+            if (offsets.at(j) == missing)
+                continue;
+            StringLocation loc = locate_string(h.data, offsets.at(j), h.addr);
+            if (!loc.buffer || !loc.len)
+                continue;
+            int idx = i * offsets.size() + j;
+            if (loc.len > 0 && loc.buffer >= h.addr &&
+                loc.buffer + loc.len <= h.addr + h.data.size()) {
+                strings[idx] = cp437_to_unicode(
+                        h.data.constData() + (loc.buffer - h.addr), loc.len);
+                continue;
+            }
+            body_index[idx] = bodies.size();
+            has_rep << (loc.len < 0);
+            if (loc.len < 0) {
+                bodies << ScatterRead(loc.buffer - STRING_REP_SIZE,
+                                      STRING_REP_SIZE + short_string_guess);
+            } else {
+                bodies << ScatterRead(loc.buffer, loc.len);
+            }
+        }
+    }
+    read_raw_batch(bodies);
+
+    // pass 3: the rest of any long strings whose length we just learned
+    QVector<ScatterRead> long_bodies;
+    QVector<int> long_index;
+    for (int idx = 0; idx < strings.size(); ++idx) {
+        int b = body_index.at(idx);
+        if (b < 0)
+            continue;
+        const ScatterRead &body = bodies.at(b);
+        if (body.data.isEmpty())
+            continue;
+        if (!has_rep.at(b)) {
+            // exact length was known up front
+            strings[idx] = cp437_to_unicode(body.data.constData(),
+                                            body.data.size());
+            continue;
+        }
+        int len = peek<qint32>(body.data, 0);
+        const char *chars = body.data.constData() + STRING_REP_SIZE;
+        if (len < 0 || len > max_len) {
+            // not a string we understand, take whatever is NUL terminated
+            strings[idx] = cp437_to_unicode(chars, short_string_guess);
+        } else if (len <= short_string_guess) {
+            strings[idx] = cp437_to_unicode(chars, len);
+        } else {
+            long_index << idx;
+            long_bodies << ScatterRead(body.addr + STRING_REP_SIZE, len);
+        }
+    }
+    read_raw_batch(long_bodies);
+    detach();
+
+    for (int i = 0; i < long_bodies.size(); ++i) {
+        const QByteArray &body = long_bodies.at(i).data;
+        strings[long_index.at(i)] = cp437_to_unicode(body.constData(),
+                                                     body.size());
+    }
+    return strings;
+}
+
 QVector<VIRTADDR> DFInstance::scan_mem(const QByteArray &needle, const uint start_addr, const uint end_addr) {
     // progress reporting
     m_scan_speed_timer->start(500);
@@ -283,8 +500,19 @@ bool DFInstance::looks_like_vector_of_pointers(const VIRTADDR &addr) {
 void DFInstance::read_raws() {
     emit progress_message(tr("Reading raws"));
 
+    GameDataReader *gdr = GameDataReader::ptr();
+    GameDataCache cache(this, "raws");
+    if (cache.load() && gdr->load_raws(cache.stream()))
+        return;
+
     LOGI << "Reading some game raws...";
-    GameDataReader::ptr()->read_raws(m_df_dir);
+    gdr->read_raws(m_df_dir);
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(GameDataCache::stream_version());
+    gdr->save_raws(out);
+    cache.save(payload);
 }
 
 QVector<Dwarf*> DFInstance::load_dwarves() {
@@ -323,6 +551,7 @@ QVector<Dwarf*> DFInstance::load_dwarves() {
     LOGD << "dwarf race index" << hexify(dwarf_race_index) <<
             hexify(dwarf_race_index - m_memory_correction) << "(UNCORRECTED)";
     emit progress_message(tr("Loading Dwarves"));
+    StringPool::clear(); // only this load's strings are worth sharing
 
     attach();
     // which race id is dwarven?
@@ -333,18 +562,50 @@ QVector<Dwarf*> DFInstance::load_dwarves() {
     emit progress_range(0, entries.size()-1);
     TRACE << "FOUND" << entries.size() << "creatures";
     if (!entries.empty()) {
-        Dwarf *d = 0;
-        int i = 0;
-        foreach(VIRTADDR creature_addr, entries) {
-            d = Dwarf::get_dwarf(this, creature_addr);
-            if (d) {
-                dwarves.append(d);
-                LOGD << "FOUND DWARF" << hexify(creature_addr)
-                     << d->nice_name();
+        // capture everything we need out of DF first, this is the only part
+        // of loading that has to talk to the remote process. Every creature
+        // struct comes back in one batch and anything that isn't one of our
+        // dwarves is dropped before any of its pointers are followed
+        DwarfDecodeContext ctx(this);
+        CreatureGatherer gatherer(this, ctx);
+        QVector<CreatureSnapshot> creatures = gatherer.gather_creatures(entries);
+        QVector<CreatureSnapshot> accepted;
+        for (int i = 0; i < creatures.size(); ++i) {
+            const CreatureSnapshot &snap = creatures.at(i);
+            QString reason;
+            if (!snap.creature.isEmpty() &&
+                DwarfDecoder::accept(snap.creature, ctx, reason)) {
+                accepted << snap;
+            } else if (!reason.isEmpty()) {
+                LOGD << "Ignoring" << read_string(snap.address + ctx.first_name)
+                        << "who appears to be" << reason;
             } else {
-                TRACE << "FOUND OTHER CREATURE" << hexify(creature_addr);
+                TRACE << "FOUND OTHER CREATURE" << hexify(snap.address);
             }
-            emit progress_value(i++);
+            emit progress_value(i);
+        }
+        gatherer.gather_details(accepted);
+
+        QVector<DwarfDecodeJob> jobs(accepted.size());
+        for (int i = 0; i < accepted.size(); ++i) {
+            jobs[i].ctx = &ctx;
+            jobs[i].snapshot = accepted.at(i);
+        }
+
+        // decoding only touches the captured bytes, so spread it across cores
+        QtConcurrent::blockingMap(jobs, &DwarfDecoder::decode_job);
+
+        // interning here rather than in the workers keeps them lock free
+        for (int i = 0; i < jobs.size(); ++i) {
+            DwarfDecodeJob &job = jobs[i];
+            foreach(QString w, job.warnings) {
+                LOGW << w;
+            }
+            DwarfDecoder::intern_strings(job.data);
+            Dwarf *d = Dwarf::get_dwarf(this, job.data);
+            dwarves.append(d);
+            LOGD << "FOUND DWARF" << hexify(job.data.address)
+                 << d->nice_name();
         }
     } else {
         // we lost the fort!
@@ -356,7 +617,8 @@ QVector<Dwarf*> DFInstance::load_dwarves() {
     return dwarves;
 }
 
-QVector<Squad*> DFInstance::load_squads() {
+QVector<Squad*> DFInstance::load_squads(
+        const QHash<int, Dwarf*> &dwarves_by_ref_id) {
 
     QVector<Squad*> squads;
     if (!m_is_ok) {
@@ -395,15 +657,60 @@ QVector<Squad*> DFInstance::load_squads() {
 
     if (!entries.empty()) {
         emit progress_range(0, entries.size()-1);
-        Squad *s = NULL;
-        int i = 0;
+        uint id_offset = m_layout->squad_offset("id");
+        uint name_offset = m_layout->squad_offset("name");
+        uint members_offset = m_layout->squad_offset("members");
+        if (id_offset == 0xFFFFFFFF || name_offset == 0xFFFFFFFF ||
+            members_offset == 0xFFFFFFFF) {
+            LOGW << "Active Memory Layout" << m_layout->filename()
+                    << "is missing squad offsets";
+            detach();
+            return squads;
+        }
+        int squad_size = qMax(id_offset + 4, name_offset + NameResolver::NAME_BYTES);
+        squad_size = qMax<int>(squad_size,
+                               members_offset + VECTOR_POINTER_OFFSET + 8);
+
+        // every squad header, then every member vector, then every member
+        QVector<ScatterRead> headers;
         foreach(VIRTADDR squad_addr, entries) {
-            s = Squad::get_squad(this, squad_addr);
-            if (s) {
-                TRACE << "FOUND SQUAD" << hexify(squad_addr) << s->name();
-                squads << s;
+            headers << ScatterRead(squad_addr, squad_size);
+        }
+        read_raw_batch(headers);
+
+        QVector<ScatterRead> member_vectors;
+        foreach(const ScatterRead &h, headers) {
+            member_vectors << vector_body(h.data, members_offset);
+        }
+        read_raw_batch(member_vectors);
+
+        QVector<ScatterRead> members;
+        QVector<int> member_owners;
+        for (int i = 0; i < member_vectors.size(); ++i) {
+            foreach(VIRTADDR member_addr,
+                    vector_pointers(member_vectors.at(i).data)) {
+                members << ScatterRead(member_addr, 4);
+                member_owners << i;
             }
-            emit progress_value(i++);
+        }
+        read_raw_batch(members);
+
+        QVector<QVector<int> > ref_ids(entries.size());
+        for (int i = 0; i < members.size(); ++i) {
+            ref_ids[member_owners.at(i)] << (members.at(i).data.isEmpty()
+                    ? -1 : peek<qint32>(members.at(i).data, 0));
+        }
+
+        for (int i = 0; i < headers.size(); ++i) {
+            const ScatterRead &h = headers.at(i);
+            if (h.data.isEmpty())
+                continue;
+            Squad *s = new Squad(this, h.addr, peek<qint32>(h.data, id_offset),
+                                 NameResolver::translated_name(h.data, name_offset));
+            s->set_members(ref_ids.at(i), dwarves_by_ref_id);
+            TRACE << "FOUND SQUAD" << hexify(h.addr) << s->name();
+            squads << s;
+            emit progress_value(i);
         }
     }
 
@@ -491,68 +798,7 @@ Word * DFInstance::read_dwarf_word(const VIRTADDR &addr) {
 }
 
 QString DFInstance::read_dwarf_name(const VIRTADDR &addr) {
-    QString result = "The";
-
-    //7 parts e.g.  ffffffff ffffffff 000006d4
-    //      ffffffff ffffffff 000002b1 ffffffff
-
-    //Unknown
-    Word * word = read_dwarf_word(addr);
-    if(word)
-        result.append(" " + capitalize(word->base()));
-
-    //Unknown
-    word = read_dwarf_word(addr + 0x04);
-    if(word)
-        result.append(" " + capitalize(word->base()));
-
-    //Verb
-    word = read_dwarf_word(addr + 0x08);
-    if(word) {
-        result.append(" " + capitalize(word->adjective()));
-    }
-
-    //Unknown
-    word = read_dwarf_word(addr + 0x0C);
-    if(word)
-        result.append(" " + capitalize(word->base()));
-
-    //Unknown
-    word = read_dwarf_word(addr + 0x10);
-    if(word)
-        result.append(" " + capitalize(word->base()));
-
-    //Noun
-    word = read_dwarf_word(addr + 0x14);
-    bool singular = false;
-    if(word) {
-        if(word->plural_noun().isEmpty()) {
-            result.append(" " + capitalize(word->noun()));
-            singular = true;
-        } else {
-            result.append(" " + capitalize(word->plural_noun()));
-        }
-    }
-
-    //of verb(noun)
-    word = read_dwarf_word(addr + 0x18);
-    if(word) {
-        if( !word->verb().isEmpty() ) {
-            if(singular) {
-                result.append(" of " + capitalize(word->verb()));
-            } else {
-                result.append(" of " + capitalize(word->present_participle_verb()));
-            }
-        } else {
-            if(singular) {
-                result.append(" of " + capitalize(word->noun()));
-            } else {
-                result.append(" of " + capitalize(word->plural_noun()));
-            }
-        }
-    }
-
-    return result.trimmed();
+    return NameResolver::read_translated_name(this, addr);
 }
 
 
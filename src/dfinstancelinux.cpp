@@ -124,15 +124,7 @@ uint DFInstanceLinux::calculate_checksum() {
 
 
 QString DFInstanceLinux::read_string(const VIRTADDR &addr) {
-    VIRTADDR buffer_addr = read_addr(addr);
-    int upper_size = 256;
-    QByteArray buf(upper_size, 0);
-    read_raw(buffer_addr, upper_size, buf);
-
-    QString ret_val(buf);
-    CP437Codec *codec = new CP437Codec;
-    ret_val = codec->toUnicode(ret_val.toAscii());
-    return ret_val;
+    return read_std_string(addr);
 }
 
 int DFInstanceLinux::write_string(const VIRTADDR &addr, const QString &str) {
@@ -196,12 +188,16 @@ int DFInstanceLinux::read_raw(const VIRTADDR &addr, int bytes, QByteArray &buffe
     attach();
 
     // open the memory virtual file for this proc (can only read once
-    // attached and child is stopped
-    QFile mem_file(QString("/proc/%1/mem").arg(m_pid));
-    if (!mem_file.open(QIODevice::ReadOnly)) {
-        LOGE << "Unable to open" << mem_file.fileName();
-        detach();
-        return 0;
+    // attached and child is stopped), unless a batch already has it open
+    QFile own_file;
+    QFile &mem_file = m_memory_file.isOpen() ? m_memory_file : own_file;
+    if (!mem_file.isOpen()) {
+        mem_file.setFileName(QString("/proc/%1/mem").arg(m_pid));
+        if (!mem_file.open(QIODevice::ReadOnly)) {
+            LOGE << "Unable to open" << mem_file.fileName();
+            detach();
+            return 0;
+        }
     }
     int bytes_read = 0; // tracks how much we've read of what was asked for
     int step_size = 0x1000; // how many bytes to read each step
@@ -219,11 +215,27 @@ int DFInstanceLinux::read_raw(const VIRTADDR &addr, int bytes, QByteArray &buffe
         buffer.replace(bytes_read, chunk.size(), chunk);
         bytes_read += chunk.size();
     }
-    mem_file.close();
+    if (&mem_file == &own_file)
+        mem_file.close();
     detach();
     return bytes_read;
 }
 
+void DFInstanceLinux::read_raw_batch(QVector<ScatterRead> &reads) {
+    // hold /proc/pid/mem open for the whole batch instead of reopening it
+    // for every block
+    attach();
+    m_memory_file.setFileName(QString("/proc/%1/mem").arg(m_pid));
+    bool opened = m_memory_file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        LOGE << "Unable to open" << m_memory_file.fileName();
+    }
+    DFInstance::read_raw_batch(reads);
+    if (opened)
+        m_memory_file.close();
+    detach();
+}
+
 int DFInstanceLinux::write_raw(const VIRTADDR &addr, const int &bytes,
                                void *buffer) {
     // try to attach, will be ignored if we're already attached
@@ -111,15 +111,7 @@ QVector<uint> DFInstanceOSX::enumerate_vector(const uint &addr) {
 }
 
 QString DFInstanceOSX::read_string(const uint &addr) {
-    VIRTADDR buffer_addr = read_addr(addr);
-    int upper_size = 256;
-    QByteArray buf(upper_size, 0);
-    read_raw(buffer_addr, upper_size, buf);
-
-    QString ret_val(buf);
-    CP437Codec *codec = new CP437Codec;
-    ret_val = codec->toUnicode(ret_val.toAscii());
-    return ret_val;
+    return read_std_string(addr);
 }
 
 int DFInstanceOSX::write_string(const uint &addr, const QString &str) {
@@ -105,31 +105,7 @@ QVector<VIRTADDR> DFInstanceWindows::enumerate_vector(const VIRTADDR &addr) {
 }
 
 QString DFInstanceWindows::read_string(const uint &addr) {
-    int len = read_int(addr + memory_layout()->string_length_offset());
-    int cap = read_int(addr + memory_layout()->string_cap_offset());
-    VIRTADDR buffer_addr = addr + memory_layout()->string_buffer_offset();
-    if (cap >= 16)
-        buffer_addr = read_addr(buffer_addr);
-
-    if (len > cap || len < 0 || len > 1024) {
-#ifdef _DEBUG
-        // probaby not really a string
-        LOGW << "Tried to read a string at" << hex << addr
-            << "but it was totally not a string...";
-#endif
-        return QString();
-    }
-    Q_ASSERT_X(len <= cap, "read_string",
-               "Length must be less than or equal to capacity!");
-    Q_ASSERT_X(len >= 0, "read_string", "Length must be >=0!");
-    Q_ASSERT_X(len < (1 << 16), "read_string",
-               "String must be of sane length!");
-
-    QByteArray buffer = get_data(buffer_addr, len);
-    CP437Codec *codec = new CP437Codec;
-    QString ret_val = codec->toUnicode(buffer);
-    delete codec; // seems to cause Qt Warnings if you delete this.
-    return ret_val;
+    return read_std_string(addr);
 }
 
 int DFInstanceWindows::write_string(const VIRTADDR &addr, const QString &str) {
@@ -150,10 +126,8 @@ int DFInstanceWindows::write_string(const VIRTADDR &addr, const QString &str) {
     int len = qMin<int>(str.length(), cap);
     write_int(addr + memory_layout()->string_length_offset(), len);
 
-    CP437Codec *codec = new CP437Codec;
-    QByteArray data = codec->fromUnicode(str);
+    QByteArray data = cp437_from_unicode(str);
     int bytes_written = write_raw(buffer_addr, len, data.data());
-    //delete codec; seems to cause Qt Warnings if you delete this.
     return bytes_written;
 }
 
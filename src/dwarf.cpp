@@ -22,6 +22,8 @@ THE SOFTWARE.
 */
 #include <QVector>
 #include "dwarf.h"
+#include "dwarfdecoder.h"
+#include "creaturegatherer.h"
 #include "dfinstance.h"
 #include "skill.h"
 #include "labor.h"
@@ -38,79 +40,57 @@ THE SOFTWARE.
 #include "militarypreference.h"
 #include "utils.h"
 
-Dwarf::Dwarf(DFInstance *df, const uint &addr, QObject *parent)
+bool Dwarf::s_show_full_name = false;
+int Dwarf::s_names_generation = 0;
+QList<QAction*> Dwarf::s_actions;
+
+Dwarf::Dwarf(DFInstance *df, const DwarfData &data, QObject *parent)
     : QObject(parent)
-    , m_id(-1)
     , m_df(df)
     , m_mem(df->memory_layout())
-    , m_address(addr)
-    , m_first_soul(0)
-    , m_race_id(-1)
-    , m_happiness(DH_MISERABLE)
-    , m_raw_happiness(0)
-    , m_is_male(true)
-    , m_show_full_name(false)
-    , m_total_xp(0)
     , m_migration_wave(0)
-    , m_raw_profession(-1)
-    , m_can_set_labors(false)
-    , m_strength(-1)
-    , m_agility(-1)
-    , m_toughness(-1)
-    , m_current_job_id(-1)
-    , m_squad_ref_id(-1)
     , m_squad_name(QString::null)
+    , m_names_generation(-1)
 {
-    read_settings();
-    refresh_data();
-    connect(DT, SIGNAL(settings_changed()), SLOT(read_settings()));
-
-    // setup context actions
-    m_actions.clear();
-    QAction *show_details = new QAction(tr("Show Details..."), this);
-    connect(show_details, SIGNAL(triggered()), SLOT(show_details()));
-    m_actions << show_details;
-    QAction *dump_mem = new QAction(tr("Dump Memory..."), this);
-    connect(dump_mem, SIGNAL(triggered()), SLOT(dump_memory()));
-    m_actions << dump_mem;
-    QAction *dump_mem_to_file = new QAction(tr("Dump Memory To File"), this);
-    connect(dump_mem_to_file, SIGNAL(triggered()), SLOT(dump_memory_to_file()));
-    m_actions << dump_mem_to_file;
-    QAction *copy_address_to_clipboard = new QAction(
-            tr("Copy Address to Clipboard"), this);
-    connect(copy_address_to_clipboard, SIGNAL(triggered()),
-            SLOT(copy_address_to_clipboard()));
-    m_actions << copy_address_to_clipboard;
-
-    QAction *dump_soul = new QAction(tr("Dump Souls..."), this);
-    connect(dump_soul, SIGNAL(triggered()), SLOT(dump_souls()));
-    m_actions << dump_soul;
+    set_data(data);
 }
 
 
-Dwarf::~Dwarf() {
-    m_traits.clear();
-    foreach(QAction *a, m_actions) {
-        a->deleteLater();
-    }
-    m_actions.clear();
-    m_skills.clear();
-}
+Dwarf::~Dwarf() {}
 
 void Dwarf::read_settings() {
-    /* This is pretty fucked up. There is no good way to let the options for
-       full name, or show dabbling to just update existing cells. Will have to
-       send signals when this stuff changes, or just bite the bullet and
-       subclass the QStandardItem for the name items in the main model
+    /* Names are rebuilt lazily (see check_names()) so a settings change
+       doesn't have to touch every dwarf in the fort right away.
        */
     QSettings *s = DT->user_settings();
     bool new_show_full_name = s->value("options/show_full_dwarf_names",
                                        false).toBool();
-    if (new_show_full_name != m_show_full_name) {
-        calc_names();
-        emit name_changed();
+    if (new_show_full_name != s_show_full_name) {
+        s_show_full_name = new_show_full_name;
+        ++s_names_generation;
+    }
+}
+
+QList<QAction*> Dwarf::get_actions() {
+    // one set of context actions is shared by every dwarf, and gets pointed
+    // at whichever dwarf is asking for it
+    if (s_actions.isEmpty()) {
+        s_actions << new QAction(tr("Show Details..."), DT);
+        s_actions << new QAction(tr("Dump Memory..."), DT);
+        s_actions << new QAction(tr("Dump Memory To File"), DT);
+        s_actions << new QAction(tr("Copy Address to Clipboard"), DT);
+        s_actions << new QAction(tr("Dump Souls..."), DT);
+    }
+    foreach(QAction *a, s_actions) {
+        a->disconnect(SIGNAL(triggered()));
     }
-    m_show_full_name = new_show_full_name;
+    connect(s_actions.at(0), SIGNAL(triggered()), SLOT(show_details()));
+    connect(s_actions.at(1), SIGNAL(triggered()), SLOT(dump_memory()));
+    connect(s_actions.at(2), SIGNAL(triggered()), SLOT(dump_memory_to_file()));
+    connect(s_actions.at(3), SIGNAL(triggered()),
+            SLOT(copy_address_to_clipboard()));
+    connect(s_actions.at(4), SIGNAL(triggered()), SLOT(dump_souls()));
+    return s_actions;
 }
 
 void Dwarf::refresh_data() {
@@ -120,318 +100,59 @@ void Dwarf::refresh_data() {
     }
     // make sure our reference is up to date to the active memory layout
     m_mem = m_df->memory_layout();
-    TRACE << "Starting refresh of dwarf data at" << hexify(m_address);
-
-    // read everything we need
-    read_id();
-    read_caste();
-    read_race();
-    read_first_name();
-    read_last_name();
-    read_nick_name();
-    calc_names();
-    read_profession();
-    read_labors();
-    read_happiness();
-    read_current_job();
-    read_souls();
-    read_squad_ref_id();
-    read_turn_count();
-
-    /* OLD Stuff from the 40d series that no longer works the same way
-    m_strength = m_df->read_int(m_address + mem->dwarf_offset("strength"));
-    TRACE << "\tSTRENGTH:" << m_strength;
-    m_toughness = m_df->read_int(m_address + mem->dwarf_offset("toughness"));
-    TRACE << "\tTOUGHNESS:" << m_toughness;
-    m_agility = m_df->read_int(m_address + mem->dwarf_offset("agility"));
-    TRACE << "\tAGILITY:" << m_agility;
-    m_squad_leader_id = m_df->read_int(m_address + mem->dwarf_offset("squad_leader_id"));
-    TRACE << "\tSQUAD LEADER ID:" << m_squad_leader_id;
-    m_squad_name = read_squad_name(m_address + mem->dwarf_offset("squad_name"));
-    TRACE << "\tSQUAD NAME:" << m_squad_name;
-    m_generic_squad_name = read_squad_name(m_address + mem->dwarf_offset("squad_name"), true);
-    TRACE << "\tGENERIC SQUAD NAME:" << m_generic_squad_name;
-    */
-
-    /* Search for a souls vector, where each soul contains a vector of skills
-    QVector<uint> vectors = m_df->find_vectors_in_range(1, m_address, 0xc00);
-    foreach(uint vec_addr, vectors) {
-        QVector<uint> entries = m_df->enumerate_vector(vec_addr);
-        uint soul = entries.at(0);
-        LOGD << nice_name() << "Found vector of" << entries.size()
-                << "valid entries at" << hex << vec_addr << "Offset:"
-                << (vec_addr - m_address) << "SOULPTR:" << soul;
-        //LOGD << m_df->pprint(soul, 0x250);
-        foreach(uint skill_vec, m_df->find_vectors_in_range(50, soul, 0x250)) {
-            QVector<uint> skills = m_df->enumerate_vector(skill_vec);
-            LOGD << nice_name() << "+" << hex << (vec_addr - m_address)
-                    << "skills offset in soul:"
-                    << (skill_vec - entries.at(0)) << "total skills:"
-                    << dec << skills.size();
-
-            foreach(Skill s, read_skills(skill_vec)) {
-                LOGD << s.name() << s.exp_summary();
-            }
-        }
-    }
-    */
-    TRACE << "finished refresh of dwarf data for dwarf:" << m_nice_name
-            << "(" << m_translated_name << ")";
-}
-
-/*******************************************************************************
-  DATA POPULATION METHODS
-*******************************************************************************/
-
-void Dwarf::read_id() {
-    m_id = m_df->read_int(m_address + m_mem->dwarf_offset("id"));
-    //m_id = m_address; // HACK: this will allow dwarfs in the list even when
-    // the id offset isn't know for this version
-    TRACE << "ID:" << m_id;
-}
-
-void Dwarf::read_caste() {
-    // TODO: actually break down this caste
-    BYTE sex = m_df->read_byte(m_address + m_mem->dwarf_offset("sex"));
-    m_is_male = (int)sex == 1;
-    TRACE << "MALE:" << m_is_male;
-}
-
-void Dwarf::read_race() {
-    m_race_id = m_df->read_int(m_address + m_mem->dwarf_offset("race"));
-    TRACE << "RACE ID:" << m_race_id;
-}
-
-void Dwarf::read_first_name() {
-    m_first_name = m_df->read_string(m_address +
-                                     m_mem->dwarf_offset("first_name"));
-    if (m_first_name.size() > 1)
-        m_first_name[0] = m_first_name[0].toUpper();
-    TRACE << "FIRSTNAME:" << m_first_name;
-}
-
-//! used by read_last_name to find word chunks
-QString Dwarf::word_chunk(uint word, bool use_generic) {
-    QString out = "";
-    if (word != 0xFFFFFFFF) {
-        if (use_generic) {
-            out = DT->get_generic_word(word);
-        } else {
-            out = DT->get_dwarf_word(word);
-        }
-    }
-    return out;
-}
-
-QString Dwarf::read_chunked_name(const VIRTADDR &addr, bool use_generic) {
-    // last name reading taken from patch by Zhentar (issue 189)
-    QString first, second, third;
-
-    first.append(word_chunk(m_df->read_addr(addr), use_generic));
-    first.append(word_chunk(m_df->read_addr(addr + 0x4), use_generic));
-    second.append(word_chunk(m_df->read_addr(addr + 0x8), use_generic));
-    second.append(word_chunk(m_df->read_addr(addr + 0x14), use_generic));
-    third.append(word_chunk(m_df->read_addr(addr + 0x18), use_generic));
-
-    QString out = first;
-    out = out.toLower();
-    if (!out.isEmpty()) {
-        out[0] = out[0].toUpper();
-    }
-    if (!second.isEmpty()) {
-        second = second.toLower();
-        second[0] = second[0].toUpper();
-        out.append(" " + second);
+    TRACE << "Starting refresh of dwarf data at" << hexify(m_data.address);
+
+    // same capture/decode path DFInstance::load_dwarves() uses in bulk
+    DwarfDecodeContext ctx(m_df);
+    CreatureGatherer gatherer(m_df, ctx);
+    QVector<CreatureSnapshot> snaps = gatherer.gather_creatures(
+            QVector<VIRTADDR>() << m_data.address);
+    if (snaps.at(0).creature.isEmpty()) {
+        LOGW << "unable to read creature at" << hexify(m_data.address);
+        return;
     }
-    if (!third.isEmpty()) {
-        third = third.toLower();
-        third[0] = third[0].toUpper();
-        out.append(" " + third);
+    gatherer.gather_details(snaps);
+    DwarfData data;
+    QStringList warnings;
+    DwarfDecoder::decode(snaps.at(0), ctx, data, warnings);
+    foreach(QString w, warnings) {
+        LOGW << w;
     }
-    return out;
-}
+    set_data(data);
 
-void Dwarf::read_last_name() {
-    VIRTADDR addr = m_address + m_mem->dwarf_offset("last_name");
-
-    //Generic
-    bool use_generic = false;
-    if (DT->user_settings()->value("options/use_generic_names", false).toBool()) {
-        use_generic = true;
-    }
-
-    m_last_name = read_chunked_name(addr, use_generic);
-    m_translated_last_name = read_chunked_name(addr);
+    TRACE << "finished refresh of dwarf data for dwarf:" << m_nice_name
+            << "(" << m_translated_name << ")";
 }
 
-
-void Dwarf::read_nick_name() {
-    m_nick_name = m_df->read_string(m_address +
-                                    m_mem->dwarf_offset("nick_name"));
-    TRACE << "\tNICKNAME:" << m_nick_name;
-    m_pending_nick_name = m_nick_name;
+void Dwarf::set_data(const DwarfData &data) {
+    m_data = data;
+    m_pending_nick_name = m_data.nick_name;
+    m_pending_custom_profession = m_data.custom_profession;
+    m_pending_labors = m_data.labors;
+    calc_names();
 }
 
 void Dwarf::calc_names() {
+    m_names_generation = s_names_generation;
+    const QString &first_name = m_data.first_name;
+    const QString &last_name = m_data.last_name;
+    const QString &translated_last_name = m_data.translated_last_name;
     if (m_pending_nick_name.isEmpty()) {
-        m_nice_name = QString("%1 %2").arg(m_first_name, m_last_name);
-        m_translated_name = QString("%1 %2").arg(m_first_name, m_translated_last_name);
+        m_nice_name = QString("%1 %2").arg(first_name, last_name);
+        m_translated_name = QString("%1 %2").arg(first_name, translated_last_name);
     } else {
-        if (m_show_full_name) {
-            m_nice_name = QString("%1 '%2' %3").arg(m_first_name, m_pending_nick_name, m_last_name);
-            m_translated_name = QString("%1 '%2' %3").arg(m_first_name, m_pending_nick_name, m_translated_last_name);
+        if (s_show_full_name) {
+            m_nice_name = QString("%1 '%2' %3").arg(first_name, m_pending_nick_name, last_name);
+            m_translated_name = QString("%1 '%2' %3").arg(first_name, m_pending_nick_name, translated_last_name);
         } else {
-            m_nice_name = QString("'%1' %2").arg(m_pending_nick_name, m_last_name);
-            m_translated_name = QString("'%1' %2").arg(m_pending_nick_name, m_translated_last_name);
+            m_nice_name = QString("'%1' %2").arg(m_pending_nick_name, last_name);
+            m_translated_name = QString("'%1' %2").arg(m_pending_nick_name, translated_last_name);
         }
     }
     // uncomment to put address at front of name
-    //m_nice_name = QString("0x%1 %2").arg(m_address, 8, 16, QChar('0')).arg(m_nice_name);
+    //m_nice_name = QString("0x%1 %2").arg(m_data.address, 8, 16, QChar('0')).arg(m_nice_name);
     // uncomment to put internal ID at front of name
-    //m_nice_name = QString("%1 %2").arg(m_id).arg(m_nice_name);
-
-    /*
-    bool debugging_labors = true;
-    if (debugging_labors) {
-        // find first labor that is on for a dwarf...
-        uchar buf[150];
-        memset(buf, 0, 150);
-        m_df->read_raw(m_address + m_df->memory_layout()->dwarf_offset("labors"), 150, &buf);
-        for(int i = 0; i < 150; ++i) {
-            if (buf[i] > 0) {
-                m_nice_name = QString("%1 - %2").arg(m_nice_name).arg(i);
-                break;
-            }
-        }
-    }
-    */
-}
-
-void Dwarf::read_profession() {
-    // first see if there is a custom prof set...
-    VIRTADDR custom_addr = m_address + m_mem->dwarf_offset("custom_profession");
-    m_custom_profession = m_df->read_string(custom_addr);
-    TRACE << "\tCUSTOM PROF:" << m_custom_profession;
-
-    // we set both to the same to know it hasn't been edited yet
-    m_pending_custom_profession = m_custom_profession;
-
-    // now read the actual profession by id
-    VIRTADDR addr = m_address + m_mem->dwarf_offset("profession");
-    m_raw_profession = m_df->read_byte(addr);
-    Profession *p = GameDataReader::ptr()->get_profession(m_raw_profession);
-    QString prof_name = tr("Unknown Profession %1").arg(m_raw_profession);
-    if (p) {
-        m_can_set_labors = p->can_assign_labors();
-        prof_name = p->name(m_is_male);
-    } else {
-        LOGE << tr("Read unknown profession with id '%1' for dwarf '%2'")
-                .arg(m_raw_profession).arg(m_nice_name);
-        m_can_set_labors = false;
-    }
-    if (!m_custom_profession.isEmpty()) {
-        m_profession =  m_custom_profession;
-    } else {
-        m_profession = prof_name;
-    }
-    TRACE << "reading profession for" << nice_name() << m_raw_profession <<
-            prof_name;
-    TRACE << "EFFECTIVE PROFESSION:" << m_profession;
-}
-
-void Dwarf::read_labors() {
-    VIRTADDR addr = m_address + m_mem->dwarf_offset("labors");
-    // read a big array of labors in one read, then pick and choose
-    // the values we care about
-    QByteArray buf(102, 0);
-    m_df->read_raw(addr, 102, buf);
-
-    // get the list of identified labors from game_data.ini
-    GameDataReader *gdr = GameDataReader::ptr();
-    foreach(Labor *l, gdr->get_ordered_labors()) {
-        bool enabled = buf.at(l->labor_id) > 0;
-        m_labors[l->labor_id] = enabled;
-        m_pending_labors[l->labor_id] = enabled;
-    }
-    // also store prefs in this structure
-    foreach(MilitaryPreference *mp, gdr->get_military_preferences()) {
-        m_labors[mp->labor_id] = static_cast<ushort>(buf[mp->labor_id]);
-        m_pending_labors[mp->labor_id] = static_cast<ushort>(buf[mp->labor_id]);
-    }
-}
-
-void Dwarf::read_happiness() {
-    VIRTADDR addr = m_address + m_mem->dwarf_offset("happiness");
-    m_raw_happiness = m_df->read_int(addr);
-    m_happiness = happiness_from_score(m_raw_happiness);
-    TRACE << "\tRAW HAPPINESS:" << m_raw_happiness;
-    TRACE << "\tHAPPINESS:" << happiness_name(m_happiness);
-}
-
-void Dwarf::read_current_job() {
-    // TODO: jobs contain info about materials being used, if we ever get the
-    // material list we could show that in here
-    VIRTADDR addr = m_address + m_mem->dwarf_offset("current_job");
-    VIRTADDR current_job_addr = m_df->read_addr(addr);
-
-    m_current_sub_job_id.clear();
-
-    TRACE << "Current job addr: " << hex << current_job_addr;
-
-    if (current_job_addr != 0) {
-        m_current_job_id = m_df->read_word(current_job_addr +
-                                     m_df->memory_layout()->job_detail("id"));
-        DwarfJob *job = GameDataReader::ptr()->get_job(m_current_job_id);
-        if (job) {
-            m_current_job = job->description;
-
-            int sub_job_offset = m_df->memory_layout()->job_detail("sub_job_id");
-            if(sub_job_offset != -1) {
-                m_current_sub_job_id = m_df->read_string(current_job_addr + sub_job_offset);
-                if(!job->reactionClass.isEmpty() && !m_current_sub_job_id.isEmpty()) {
-                    RawObjectPtr reaction = GameDataReader::ptr()->
-                            get_reaction(job->reactionClass, m_current_sub_job_id);
-                    if(!reaction.isNull()) {
-                        m_current_job = capitalize(reaction->get_value("NAME", m_current_job));
-                        TRACE << "Sub job: " << m_current_sub_job_id << m_current_job;
-                    }
-                }
-            }
-        } else {
-            m_current_job = tr("Unknown job");
-        }
-    } else {
-        bool is_on_break = false;
-        MemoryLayout* layout = m_df->memory_layout();
-        uint states_offset = layout->dwarf_offset("states");
-        if (states_offset) {
-            VIRTADDR states_addr = m_address + states_offset;
-            QVector<uint> entries = m_df->enumerate_vector(states_addr);
-            short on_break_value = layout->job_detail("on_break_flag");
-            foreach(uint entry, entries) {
-                if (m_df->read_short(entry) == on_break_value) {
-                    is_on_break = true;
-                    break; // no pun intended
-                }
-            }
-        }
-        m_current_job = is_on_break ? tr("On Break") : tr("No Job");
-    }
-    TRACE << "CURRENT JOB:" << m_current_job_id << m_current_sub_job_id << m_current_job;
-}
-
-void Dwarf::read_souls() {
-    VIRTADDR soul_vector = m_address + m_mem->dwarf_offset("souls");
-    QVector<VIRTADDR> souls = m_df->enumerate_vector(soul_vector);
-    if (souls.size() != 1) {
-        LOGW << nice_name() << "has" << souls.size() << "souls!";
-        return;
-    }
-    m_first_soul = souls.at(0);
-    read_skills();
-    read_traits();
-    TRACE << "SKILLS:" << m_skills.size();
-    TRACE << "TRAITS:" << m_traits.size();
+    //m_nice_name = QString("%1 %2").arg(m_data.id).arg(m_nice_name);
 }
 
 
@@ -440,13 +161,13 @@ void Dwarf::read_souls() {
 QString Dwarf::profession() {
     if (!m_pending_custom_profession.isEmpty())
         return m_pending_custom_profession;
-    if (!m_custom_profession.isEmpty())
-        return m_custom_profession;
-    return m_profession;
+    if (!m_data.custom_profession.isEmpty())
+        return m_data.custom_profession;
+    return m_data.profession;
 }
 
 bool Dwarf::active_military() {
-    Profession *p = GameDataReader::ptr()->get_profession(m_raw_profession);
+    Profession *p = GameDataReader::ptr()->get_profession(m_data.raw_profession);
     return p && p->is_military();
 }
 
@@ -487,180 +208,68 @@ Dwarf *Dwarf::get_dwarf(DFInstance *df, const VIRTADDR &addr) {
     TRACE << "attempting to load dwarf at" << addr << "using memory layout"
             << mem->game_version();
 
-    quint32 flags1 = df->read_addr(addr + mem->dwarf_offset("flags1"));
-    quint32 flags2 = df->read_addr(addr + mem->dwarf_offset("flags2"));
-    WORD race_id = df->read_word(addr + mem->dwarf_offset("race"));
-
-    if (race_id != df->dwarf_race_id()) { // we only care about dwarfs
-        TRACE << "Ignoring creature with race ID of " << hex << race_id;
+    DwarfDecodeContext ctx(df);
+    CreatureGatherer gatherer(df, ctx);
+    QVector<CreatureSnapshot> snaps = gatherer.gather_creatures(
+            QVector<VIRTADDR>() << addr);
+    if (snaps.at(0).creature.isEmpty())
         return 0;
-    }
-    Dwarf *unverified_dwarf = new Dwarf(df, addr, df);
-    TRACE << "examining dwarf at" << hex << addr;
-    TRACE << "FLAGS1 :" << hexify(flags1);
-    TRACE << "FLAGS2 :" << hexify(flags2);
-    TRACE << "RACE   :" << hexify(race_id);
-
-    if (mem->is_complete()) {
-        QHash<uint, QString> flags = mem->valid_flags_1();
-        foreach(uint flag, flags.uniqueKeys()) {
-            QString reason = flags[flag];
-            if ((flags1 & flag) != flag) {
-                LOGD << "Ignoring" << unverified_dwarf->nice_name() <<
-                        "who appears to be" << reason;
-                delete unverified_dwarf;
-                return 0;
-            }
-        }
-
-        flags = mem->invalid_flags_1();
-        foreach(uint flag, flags.uniqueKeys()) {
-            QString reason = flags[flag];
-            if ((flags1 & flag) == flag) {
-                LOGD << "Ignoring" << unverified_dwarf->nice_name()
-                        << "who appears to be" << reason;
-                delete unverified_dwarf;
-                return 0;
-            }
-        }
-
-        flags = mem->valid_flags_2();
-        foreach(uint flag, flags.uniqueKeys()) {
-            QString reason = flags[flag];
-            if ((flags2 & flag) != flag) {
-                LOGD << "Ignoring" << unverified_dwarf->nice_name() <<
-                        "who appears to be" << reason;
-                delete unverified_dwarf;
-                return 0;
-            }
-        }
-
-        flags = mem->invalid_flags_2();
-        foreach(uint flag, flags.uniqueKeys()) {
-            QString reason = flags[flag];
-            if ((flags2 & flag) == flag) {
-                LOGD << "Ignoring" << unverified_dwarf->nice_name()
-                        << "who appears to be" << reason;
-                delete unverified_dwarf;
-                return 0;
-            }
-        }
-
-        // HACK: ugh... so ugly, but this seems to be the best way to filter
-        // out kidnapped babies
-        short baby_id = -1;
-        foreach(Profession *p, GameDataReader::ptr()->get_professions()) {
-            if (p->name(true) == "Baby") {
-                baby_id = p->id();
-                break;
-            }
-        }
-        if (unverified_dwarf->raw_profession() == baby_id) {
-            if ((flags1 & 0x200) != 0x200) {
-                // kidnapped flag? seems like it
-                LOGD << "Ignoring" << unverified_dwarf->nice_name() <<
-                        "who appears to be a kidnapped baby";
-                delete unverified_dwarf;
-                return 0;
-            }
+    QString reason;
+    if (!DwarfDecoder::accept(snaps.at(0).creature, ctx, reason)) {
+        if (!reason.isEmpty()) {
+            LOGD << "Ignoring" << df->read_string(addr + ctx.first_name)
+                    << "who appears to be" << reason;
         }
+        return 0;
     }
-    return unverified_dwarf;
-}
-
-
-void Dwarf::read_traits() {
-    VIRTADDR addr = m_first_soul + m_mem->soul_detail("traits");
-    m_traits.clear();
-    for (int i = 0; i < 30; ++i) {
-        short val = m_df->read_short(addr + i * 2);
-        int deviation = abs(val - 50); // how far from the norm is this trait?
-        if (deviation <= 10) {
-            val = -1; // this will cause median scores to not be treated as "active" traits
-        }
-        m_traits.insert(i, val);
+    gatherer.gather_details(snaps);
+    DwarfData data;
+    QStringList warnings;
+    DwarfDecoder::decode(snaps.at(0), ctx, data, warnings);
+    foreach(QString w, warnings) {
+        LOGW << w;
     }
+    return get_dwarf(df, data);
 }
 
-void Dwarf::read_squad_ref_id() {
-    m_squad_ref_id = m_df->read_int(m_address + m_mem->dwarf_offset("squad_ref_id"));
-    TRACE << "Squad Reference ID:" << m_squad_ref_id;
-}
-
-void Dwarf::read_turn_count() {
-    m_turn_count = m_df->read_int(m_address + m_mem->dwarf_offset("turn_count"));
-    TRACE << "Turn Count:" << m_turn_count;
-}
-
-void Dwarf::read_skills() {
-    VIRTADDR addr = m_first_soul + m_mem->soul_detail("skills");
-    m_total_xp = 0;
-    m_skills.clear();
-    QVector<VIRTADDR> entries = m_df->enumerate_vector(addr);
-    TRACE << "Reading skills for" << nice_name() << "found:" << entries.size();
-    short type = 0;
-    short rating = 0;
-    int xp = 0;
-    int last_used = 0;
-    int rust = 0;
-    int rust_counter = 0;
-    int demotion_counter = 0;
-    foreach(VIRTADDR entry, entries) {
-        /* type, level, experience, last used counter, rust, rust counter,
-        demotion counter
-        */
-        type = m_df->read_short(entry);
-        rating = m_df->read_short(entry + 0x04);
-        xp = m_df->read_int(entry + 0x08);
-        last_used =m_df->read_int(entry + 0x0C);
-        rust = m_df->read_int(entry + 0x10);
-        rust_counter = m_df->read_int(entry + 0x14);
-        demotion_counter = m_df->read_int(entry + 0x18);
-
-        TRACE   << "reading skill at" << hex << entry << "type" << dec << type
-                << "rating" << rating << "xp:" << xp << "last_used:"
-                << last_used << "rust:" << rust << "rust counter:"
-                << rust_counter << "demotions:" << demotion_counter;
-        Skill s(type, xp, rating);
-        m_total_xp += s.actual_exp();
-        m_skills.append(s);
-    }
+Dwarf *Dwarf::get_dwarf(DFInstance *df, const DwarfData &data) {
+    TRACE << "examining dwarf at" << hex << data.address;
+    TRACE << "FLAGS1 :" << hexify(data.flags1);
+    TRACE << "FLAGS2 :" << hexify(data.flags2);
+    TRACE << "RACE   :" << hexify(data.race_id);
+    return new Dwarf(df, data, df);
 }
 
 const Skill Dwarf::get_skill(int skill_id) {
-    foreach(Skill s, m_skills) {
-        if (s.id() == skill_id) {
-            return s;
-        }
-    }
-    return Skill(skill_id, 0, -1);
-}
-
-short Dwarf::get_rating_by_skill(int skill_id) {
-    short retval = -1;
-    foreach(Skill s, m_skills) {
-        if (s.id() == skill_id) {
-            retval = s.rating();
-            break;
+    if (!m_data.has_skill(skill_id))
+        return Skill(skill_id, 0, -1);
+    return Skill(skill_id, m_data.skill_exp[skill_id],
+                 m_data.skill_ratings[skill_id]);
+}
+
+QVector<Skill> Dwarf::get_skills() {
+    QVector<Skill> skills;
+    for (int word = 0; word < DwarfData::MAX_SKILLS / 64; ++word) {
+        quint64 bits = m_data.skill_mask[word];
+        for (int bit = 0; bits; ++bit, bits >>= 1) {
+            if (!(bits & 1))
+                continue;
+            int i = word * 64 + bit;
+            skills << Skill(i, m_data.skill_exp[i], m_data.skill_ratings[i]);
         }
     }
-    return retval;
+    return skills;
 }
 
 short Dwarf::get_rating_by_labor(int labor_id) {
-    GameDataReader *gdr = GameDataReader::ptr();
-    Labor *l = gdr->get_labor(labor_id);
-    if (l)
-        return get_rating_by_skill(l->skill_id);
-    else
-        return -1;
+    return get_rating_by_skill(GameDataReader::ptr()->get_skill_for_labor(labor_id));
 }
 
 
 
 short Dwarf::pref_value(const int &labor_id) {
     if (!m_pending_labors.contains(labor_id)) {
-        LOGW << m_nice_name << "pref_value for labor_id" << labor_id << "was not found in pending labors hash!";
+        LOGW << m_nice_name << "pref_value for labor_id" << labor_id << "was not found in pending labors!";
         return 0;
     }
     return m_pending_labors.value(labor_id);
@@ -668,30 +277,51 @@ short Dwarf::pref_value(const int &labor_id) {
 
 void Dwarf::toggle_pref_value(const int &labor_id) {
     short next_val = GameDataReader::ptr()->get_military_preference(labor_id)->next_val(pref_value(labor_id));
-    m_pending_labors[labor_id] = next_val;
+    m_pending_labors.set(labor_id, next_val);
 }
 
 
 bool Dwarf::labor_enabled(int labor_id) {
-    return m_pending_labors.value(labor_id, false);
+    return m_pending_labors.enabled().test(labor_id);
 }
 
 bool Dwarf::is_labor_state_dirty(int labor_id) {
-    return m_labors[labor_id] != m_pending_labors[labor_id];
+    return m_data.labors.enabled().test(labor_id) != m_pending_labors.enabled().test(labor_id);
+}
+
+bool Dwarf::is_pref_state_dirty(int labor_id) {
+    return m_data.labors.value(labor_id) != m_pending_labors.value(labor_id);
+}
+
+LaborSet Dwarf::dirty_labor_set() const {
+    return (m_data.labors.enabled() ^ m_pending_labors.enabled()) &
+           GameDataReader::ptr()->get_labor_ids();
+}
+
+LaborSet Dwarf::dirty_pref_set() const {
+    return m_pending_labors.differences(m_data.labors) &
+           GameDataReader::ptr()->get_military_preference_ids();
 }
 
 QVector<int> Dwarf::get_dirty_labors() {
     QVector<int> labors;
-    Q_ASSERT(m_labors.size() == m_pending_labors.size());
-    foreach(int labor_id, m_pending_labors.uniqueKeys()) {
-        if (is_labor_state_dirty(labor_id))
+    LaborSet dirty_labors = dirty_labor_set();
+    if (!dirty_labors.is_empty()) { // in display order
+        foreach(Labor *l, GameDataReader::ptr()->get_ordered_labors()) {
+            if (dirty_labors.test(l->labor_id))
+                labors << l->labor_id;
+        }
+    }
+    LaborSet dirty_prefs = dirty_pref_set();
+    for (int labor_id = 0; !dirty_prefs.is_empty() && labor_id < LaborSet::MAX_LABORS; ++labor_id) {
+        if (dirty_prefs.test(labor_id) && !dirty_labors.test(labor_id))
             labors << labor_id;
     }
     return labors;
 }
 
 bool Dwarf::toggle_labor(int labor_id) {
-    set_labor(labor_id, !m_pending_labors[labor_id]);
+    set_labor(labor_id, !labor_enabled(labor_id));
     return true;
 }
 
@@ -702,8 +332,8 @@ void Dwarf::set_labor(int labor_id, bool enabled) {
         return;
     }
 
-    if (!m_can_set_labors && !DT->labor_cheats_allowed()) {
-        LOGD << "IGNORING SET LABOR OF ID:" << labor_id << "TO:" << enabled << "FOR:" << m_nice_name << "PROF_ID" << m_raw_profession
+    if (!m_data.can_set_labors && !DT->labor_cheats_allowed()) {
+        LOGD << "IGNORING SET LABOR OF ID:" << labor_id << "TO:" << enabled << "FOR:" << m_nice_name << "PROF_ID" << m_data.raw_profession
              << "PROF_NAME:" << profession() << "CUSTOM:" << m_pending_custom_profession;
         return;
     }
@@ -711,17 +341,17 @@ void Dwarf::set_labor(int labor_id, bool enabled) {
     if (enabled) { // user is turning a labor on, so we must turn off exclusives
         foreach(int excluded, l->get_excluded_labors()) {
             TRACE << "LABOR" << labor_id << "excludes" << excluded;
-            m_pending_labors[excluded] = false;
+            m_pending_labors.set(excluded, 0);
         }
     }
-    m_pending_labors[labor_id] = enabled;
+    m_pending_labors.set(labor_id, enabled ? 1 : 0);
 }
 
 int Dwarf::pending_changes() {
-    int cnt = get_dirty_labors().size();
-    if (m_nick_name != m_pending_nick_name)
+    int cnt = (dirty_labor_set() | dirty_pref_set()).count();
+    if (m_data.nick_name != m_pending_nick_name)
         cnt++;
-    if (m_custom_profession != m_pending_custom_profession)
+    if (m_data.custom_profession != m_pending_custom_profession)
         cnt++;
     return cnt;
 }
@@ -732,30 +362,30 @@ void Dwarf::clear_pending() {
 
 void Dwarf::commit_pending() {
     MemoryLayout *mem = m_df->memory_layout();
-    int addr = m_address + mem->dwarf_offset("labors");
+    int addr = m_data.address + mem->dwarf_offset("labors");
 
     QByteArray buf(102, 0);
     m_df->read_raw(addr, 102, buf); // set the buffer as it is in-game
-    foreach(int labor_id, m_pending_labors.uniqueKeys()) {
-        if (labor_id < 0)
-            continue;
-        // change values to what's pending
-        buf[labor_id] = m_pending_labors.value(labor_id);
+    // change values to what's pending
+    // one byte per id, whether it's a labor, a preference or both
+    for (int labor_id = 0; labor_id < buf.size(); ++labor_id) {
+        if (m_pending_labors.contains(labor_id))
+            buf[labor_id] = m_pending_labors.value(labor_id);
     }
 
     m_df->write_raw(addr, 102, buf.data());
 
     // We'll set the "recheck_equipment" flag because there was a labor change.
-    BYTE recheck_equipment = m_df->read_byte(m_address +
+    BYTE recheck_equipment = m_df->read_byte(m_data.address +
                                      mem->dwarf_offset("recheck_equipment"));
     recheck_equipment |= 1;
-    m_df->write_raw(m_address + mem->dwarf_offset("recheck_equipment"), 1,
+    m_df->write_raw(m_data.address + mem->dwarf_offset("recheck_equipment"), 1,
                     &recheck_equipment);
 
-    if (m_pending_nick_name != m_nick_name)
-        m_df->write_string(m_address + mem->dwarf_offset("nick_name"), m_pending_nick_name);
-    if (m_pending_custom_profession != m_custom_profession)
-        m_df->write_string(m_address + mem->dwarf_offset("custom_profession"), m_pending_custom_profession);
+    if (m_pending_nick_name != m_data.nick_name)
+        m_df->write_string(m_data.address + mem->dwarf_offset("nick_name"), m_pending_nick_name);
+    if (m_pending_custom_profession != m_data.custom_profession)
+        m_df->write_string(m_data.address + mem->dwarf_offset("custom_profession"), m_pending_custom_profession);
     refresh_data();
 }
 
@@ -769,22 +399,24 @@ void Dwarf::set_custom_profession_text(const QString &prof_text) {
 }
 
 int Dwarf::apply_custom_profession(CustomProfession *cp) {
-    foreach(int labor_id, m_pending_labors.uniqueKeys()) {
-        set_labor(labor_id, false); // turn off everything...
+    foreach(Labor *l, GameDataReader::ptr()->get_ordered_labors()) {
+        set_labor(l->labor_id, false); // turn off everything...
     }
     foreach(int labor_id, cp->get_enabled_labors()) {
         set_labor(labor_id, true); // only turn on what this prof has enabled...
     }
     m_pending_custom_profession = cp->get_name();
-    return get_dirty_labors().size();
+    return dirty_labor_set().count();
 }
 
 QTreeWidgetItem *Dwarf::get_pending_changes_tree() {
-    QVector<int> labors = get_dirty_labors();
+    LaborSet dirty_labors = dirty_labor_set();
+    LaborSet dirty_prefs = dirty_pref_set();
     QTreeWidgetItem *d_item = new QTreeWidgetItem;
-    d_item->setText(0, QString("%1 (%2)").arg(nice_name()).arg(labors.size()));
+    d_item->setText(0, QString("%1 (%2)").arg(nice_name())
+                    .arg((dirty_labors | dirty_prefs).count()));
     d_item->setData(0, Qt::UserRole, id());
-    if (m_pending_nick_name != m_nick_name) {
+    if (m_pending_nick_name != m_data.nick_name) {
         QTreeWidgetItem *i = new QTreeWidgetItem(d_item);
         QString nick = m_pending_nick_name;
         if (nick.isEmpty())
@@ -793,7 +425,7 @@ QTreeWidgetItem *Dwarf::get_pending_changes_tree() {
         i->setIcon(0, QIcon(":img/book_edit.png"));
         i->setData(0, Qt::UserRole, id());
     }
-    if (m_pending_custom_profession != m_custom_profession) {
+    if (m_pending_custom_profession != m_data.custom_profession) {
         QTreeWidgetItem *i = new QTreeWidgetItem(d_item);
         QString prof = m_pending_custom_profession;
         if (prof.isEmpty())
@@ -802,59 +434,57 @@ QTreeWidgetItem *Dwarf::get_pending_changes_tree() {
         i->setIcon(0, QIcon(":img/book_edit.png"));
         i->setData(0, Qt::UserRole, id());
     }
-    foreach(int labor_id, labors) {
-        Labor *l = GameDataReader::ptr()->get_labor(labor_id);
-        MilitaryPreference *mp = GameDataReader::ptr()->get_military_preference(labor_id);
-
-        if (!l || l->labor_id != labor_id) {
-            // this may be a mil pref not a labor..
-            if (!mp || mp->labor_id != labor_id) {
-                LOGW << "somehow got a change to an unknown labor with id:" << labor_id;
-                continue;
-            }
-        }
-
+    // the dirty sets only hold known ids, so every lookup succeeds
+    GameDataReader *gdr = GameDataReader::ptr();
+    foreach(Labor *l, gdr->get_ordered_labors()) {
+        if (!dirty_labors.test(l->labor_id))
+            continue;
         QTreeWidgetItem *i = new QTreeWidgetItem(d_item);
-        if (l) {
-            i->setText(0, l->name);
-            if (labor_enabled(labor_id)) {
-                i->setIcon(0, QIcon(":img/add.png"));
-            } else {
-                i->setIcon(0, QIcon(":img/delete.png"));
-            }
-        } else if (mp) {
-            i->setText(0, QString("Set %1 to %2").arg(mp->name).arg(mp->value_name(pref_value(labor_id))));
-            i->setIcon(0, QIcon(":img/arrow_switch.png"));
+        i->setText(0, l->name);
+        if (labor_enabled(l->labor_id)) {
+            i->setIcon(0, QIcon(":img/add.png"));
+        } else {
+            i->setIcon(0, QIcon(":img/delete.png"));
         }
         i->setData(0, Qt::UserRole, id());
     }
+    for (int labor_id = 0; !dirty_prefs.is_empty() && labor_id < LaborSet::MAX_LABORS; ++labor_id) {
+        if (!dirty_prefs.test(labor_id) || dirty_labors.test(labor_id))
+            continue; // listed once, as the labor
+        MilitaryPreference *mp = gdr->get_military_preference(labor_id);
+        QTreeWidgetItem *i = new QTreeWidgetItem(d_item);
+        i->setText(0, QString("Set %1 to %2").arg(mp->name).arg(mp->value_name(pref_value(labor_id))));
+        i->setIcon(0, QIcon(":img/arrow_switch.png"));
+        i->setData(0, Qt::UserRole, id());
+    }
     return d_item;
 }
 
 QString Dwarf::tooltip_text() {
     QString skill_summary, trait_summary;
-    QVector<Skill> *skills = get_skills();
-    qSort(*skills);
+    QVector<Skill> skills = get_skills();
+    qSort(skills);
 
     QSettings *s = DT->user_settings();
     bool show_dabbling = s->value("options/show_dabbling_in_tooltips", true)
                          .toBool();
-    for (int i = skills->size() - 1; i >= 0; --i) {
+    for (int i = skills.size() - 1; i >= 0; --i) {
         // check options to see if we should show dabbling skills
-        if (skills->at(i).rating() < 1 && !show_dabbling) {
+        if (skills.at(i).rating() < 1 && !show_dabbling) {
             continue;
         }
-        skill_summary.append(QString("<li>%1</li>").arg(skills->at(i).to_string()));
+        skill_summary.append(QString("<li>%1</li>").arg(skills.at(i).to_string()));
     }
     GameDataReader *gdr = GameDataReader::ptr();
-    for (int i = 0; i <= m_traits.size(); ++i) {
-        if (m_traits.value(i) == -1)
+    const short *traits = m_data.traits;
+    for (int i = 0; i < DwarfData::TRAIT_COUNT; ++i) {
+        if (traits[i] == -1)
             continue;
         Trait *t = gdr->get_trait(i);
         if (!t)
             continue;
-        trait_summary.append(QString("%1").arg(t->level_message(m_traits.value(i))));
-        if (i < m_traits.size() - 1) // second to last
+        trait_summary.append(QString("%1").arg(t->level_message(traits[i])));
+        if (i < DwarfData::TRAIT_COUNT - 1) // second to last
             trait_summary.append(", ");
     }
 
@@ -863,10 +493,10 @@ QString Dwarf::tooltip_text() {
         "<b>Profession:</b> %5<br/><br/>"
         "<b>Skills:</b><ul>%6</ul><br/>"
         "<b>Traits:</b> %7<br/>")
-        .arg(m_nice_name)
-        .arg(m_translated_name)
-        .arg(happiness_name(m_happiness))
-        .arg(m_raw_happiness)
+        .arg(nice_name())
+        .arg(translated_name())
+        .arg(happiness_name(get_happiness()))
+        .arg(m_data.raw_happiness)
         .arg(profession())
         .arg(skill_summary)
         .arg(trait_summary);
@@ -877,15 +507,15 @@ void Dwarf::dump_memory() {
     d->setAttribute(Qt::WA_DeleteOnClose, true);
     d->setWindowTitle(QString("%1, %2 [addr: 0x%3] [id:%4]")
         .arg(m_nice_name).arg(profession())
-        .arg(m_address, 8, 16, QChar('0'))
-        .arg(m_id));
+        .arg(m_data.address, 8, 16, QChar('0'))
+        .arg(m_data.id));
     d->resize(800, 600);
     QVBoxLayout *v = new QVBoxLayout(d);
     QTextEdit *te = new QTextEdit(d);
     te->setReadOnly(true);
     te->setFontFamily("Courier");
     te->setFontPointSize(8);
-    QByteArray data = m_df->get_data(m_address, 0xb90);
+    QByteArray data = m_df->get_data(m_data.address, 0xb90);
     te->setText(m_df->pprint(data));
     v->addWidget(te);
     d->setLayout(v);
@@ -893,7 +523,7 @@ void Dwarf::dump_memory() {
 }
 
 void Dwarf::dump_souls() {
-    VIRTADDR soul_vector = m_address + m_mem->dwarf_offset("souls");
+    VIRTADDR soul_vector = m_data.address + m_mem->dwarf_offset("souls");
     QVector<VIRTADDR> souls = m_df->enumerate_vector(soul_vector);
     if (souls.size() < 1) {
         LOGW << nice_name() << "has no soul!";
@@ -927,8 +557,8 @@ void Dwarf::dump_memory_to_file() {
     QFile *f = new QFile(d.filePath(filename), this);
     if (f->open(QFile::ReadWrite)) {
         f->write(QString("NAME: %1\n").arg(nice_name()).toAscii());
-        f->write(QString("ADDRESS: %1\n").arg(hexify(m_address)).toAscii());
-        QByteArray data = m_df->get_data(m_address, 0xb90);
+        f->write(QString("ADDRESS: %1\n").arg(hexify(m_data.address)).toAscii());
+        QByteArray data = m_df->get_data(m_data.address, 0xb90);
         f->write(m_df->pprint(data).toAscii());
         f->close();
         QMessageBox::information(DT->get_main_window(), tr("Dumped"),
@@ -948,34 +578,18 @@ void Dwarf::show_details() {
 }
 
 void Dwarf::copy_address_to_clipboard() {
-    qApp->clipboard()->setText(hexify(m_address));
+    qApp->clipboard()->setText(hexify(m_data.address));
 }
 
 Skill Dwarf::highest_skill() {
-    Skill highest(0, 0, 0);
-    foreach(Skill s, m_skills) {
-        if (s.rating() > highest.rating()) {
-            highest = s;
-        }
-    }
-    return highest;
-}
-
-int Dwarf::total_skill_levels() {
-    int ret_val = 0;
-    foreach(Skill s, m_skills) {
-        ret_val += s.rating();
-    }
-    return ret_val;
+    int highest = m_data.highest_skill_id;
+    if (highest < 0)
+        return Skill(0, 0, 0);
+    return Skill(highest, m_data.skill_exp[highest],
+                 m_data.skill_ratings[highest]);
 }
 
 int Dwarf::total_assigned_labors() {
-    // get the list of identified labors from game_data.ini
-    int ret_val = 0;
-    GameDataReader *gdr = GameDataReader::ptr();
-    foreach(Labor *l, gdr->get_ordered_labors()) {
-        if (m_labors[l->labor_id] > 0)
-            ret_val++;
-    }
-    return ret_val;
+    // a preference sharing an id with a labor enables it when non-zero
+    return (m_data.labors.enabled() & GameDataReader::ptr()->get_labor_ids()).count();
 }
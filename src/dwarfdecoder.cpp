@@ -0,0 +1,299 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "dwarfdecoder.h"
+#include "dwarf.h"
+#include "dfinstance.h"
+#include "memorylayout.h"
+#include "gamedatareader.h"
+#include "dwarftherapist.h"
+#include "profession.h"
+#include "dwarfjob.h"
+#include "militarypreference.h"
+#include "defines.h"
+#include "stringpool.h"
+#include "nameresolver.h"
+#include "skill.h"
+#include "truncatingfilelogger.h"
+
+static inline void grow_to_cover(int &size, uint offset, int bytes) {
+    if (offset != 0xFFFFFFFF && (int)offset + bytes > size)
+        size = offset + bytes;
+}
+
+DwarfDecodeContext::DwarfDecodeContext(DFInstance *df)
+    : on_break_value(0)
+    , creature_size(0)
+    , soul_size(0)
+    , job_size(0)
+    , dwarf_race_id(df->dwarf_race_id())
+    , layout_complete(false)
+    , baby_id(-1)
+    , use_generic_names(false)
+{
+    MemoryLayout *mem = df->memory_layout();
+    first_name = mem->dwarf_offset("first_name");
+    nick_name = mem->dwarf_offset("nick_name");
+    last_name = mem->dwarf_offset("last_name");
+    custom_profession = mem->dwarf_offset("custom_profession");
+    profession = mem->dwarf_offset("profession");
+    race = mem->dwarf_offset("race");
+    flags1 = mem->dwarf_offset("flags1");
+    flags2 = mem->dwarf_offset("flags2");
+    sex = mem->dwarf_offset("sex");
+    id = mem->dwarf_offset("id");
+    current_job = mem->dwarf_offset("current_job");
+    turn_count = mem->dwarf_offset("turn_count");
+    states = mem->dwarf_offset("states");
+    souls = mem->dwarf_offset("souls");
+    labors = mem->dwarf_offset("labors");
+    happiness = mem->dwarf_offset("happiness");
+    squad_ref_id = mem->dwarf_offset("squad_ref_id");
+    soul_skills = mem->soul_detail("skills");
+    soul_traits = mem->soul_detail("traits");
+    job_id = mem->job_detail("id");
+    job_sub_job_id = mem->job_detail("sub_job_id");
+    on_break_value = mem->job_detail("on_break_flag");
+
+    // names, strings and vectors are at most 0x1C bytes wide on any platform
+    grow_to_cover(creature_size, first_name, 0x1C);
+    grow_to_cover(creature_size, nick_name, 0x1C);
+    grow_to_cover(creature_size, last_name, 0x1C);
+    grow_to_cover(creature_size, custom_profession, 0x1C);
+    grow_to_cover(creature_size, profession, 1);
+    grow_to_cover(creature_size, race, 4);
+    grow_to_cover(creature_size, flags1, 4);
+    grow_to_cover(creature_size, flags2, 4);
+    grow_to_cover(creature_size, sex, 1);
+    grow_to_cover(creature_size, id, 4);
+    grow_to_cover(creature_size, current_job, 4);
+    grow_to_cover(creature_size, turn_count, 4);
+    grow_to_cover(creature_size, states, 0x10);
+    grow_to_cover(creature_size, souls, 0x10);
+    grow_to_cover(creature_size, labors, 102);
+    grow_to_cover(creature_size, happiness, 4);
+    grow_to_cover(creature_size, squad_ref_id, 4);
+    grow_to_cover(soul_size, soul_skills, 0x10);
+    grow_to_cover(soul_size, soul_traits, 30 * sizeof(short));
+    grow_to_cover(job_size, job_id, sizeof(WORD));
+
+    layout_complete = mem->is_complete();
+    valid_flags_1 = mem->valid_flags_1();
+    valid_flags_2 = mem->valid_flags_2();
+    invalid_flags_1 = mem->invalid_flags_1();
+    invalid_flags_2 = mem->invalid_flags_2();
+
+    // HACK: ugh... so ugly, but this seems to be the best way to filter
+    // out kidnapped babies
+    foreach(Profession *p, GameDataReader::ptr()->get_professions()) {
+        if (p->name(true) == "Baby") {
+            baby_id = p->id();
+            break;
+        }
+    }
+
+    use_generic_names = DT->user_settings()->value("options/use_generic_names",
+                                                   false).toBool();
+}
+
+bool DwarfDecoder::accept(const QByteArray &creature,
+                          const DwarfDecodeContext &ctx, QString &reason) {
+    reason.clear();
+    if (peek<WORD>(creature, ctx.race) != ctx.dwarf_race_id)
+        return false; // we only care about dwarfs
+    if (!ctx.layout_complete)
+        return true;
+
+    quint32 flags1 = peek<quint32>(creature, ctx.flags1);
+    quint32 flags2 = peek<quint32>(creature, ctx.flags2);
+
+    foreach(uint flag, ctx.valid_flags_1.uniqueKeys()) {
+        if ((flags1 & flag) != flag) {
+            reason = ctx.valid_flags_1.value(flag);
+            return false;
+        }
+    }
+    foreach(uint flag, ctx.invalid_flags_1.uniqueKeys()) {
+        if ((flags1 & flag) == flag) {
+            reason = ctx.invalid_flags_1.value(flag);
+            return false;
+        }
+    }
+    foreach(uint flag, ctx.valid_flags_2.uniqueKeys()) {
+        if ((flags2 & flag) != flag) {
+            reason = ctx.valid_flags_2.value(flag);
+            return false;
+        }
+    }
+    foreach(uint flag, ctx.invalid_flags_2.uniqueKeys()) {
+        if ((flags2 & flag) == flag) {
+            reason = ctx.invalid_flags_2.value(flag);
+            return false;
+        }
+    }
+    if (peek<BYTE>(creature, ctx.profession) == ctx.baby_id &&
+        (flags1 & 0x200) != 0x200) {
+        // kidnapped flag? seems like it
+        reason = "a kidnapped baby";
+        return false;
+    }
+    return true;
+}
+
+void DwarfDecoder::decode(const CreatureSnapshot &snap,
+                          const DwarfDecodeContext &ctx, DwarfData &d,
+                          QStringList &warnings) {
+    GameDataReader *gdr = GameDataReader::ptr();
+    const QByteArray &c = snap.creature;
+
+    d.address = snap.address;
+    d.id = peek<qint32>(c, ctx.id);
+    d.is_male = peek<BYTE>(c, ctx.sex) == 1;
+    d.race_id = peek<qint32>(c, ctx.race);
+    d.flags1 = peek<quint32>(c, ctx.flags1);
+    d.flags2 = peek<quint32>(c, ctx.flags2);
+
+    // names
+    QString first_name = snap.first_name;
+    if (first_name.size() > 1)
+        first_name[0] = first_name[0].toUpper();
+    d.first_name = first_name;
+    d.last_name = NameResolver::last_name(
+            c, ctx.last_name, ctx.use_generic_names ? NameResolver::NL_GENERIC
+                                                    : NameResolver::NL_DWARF);
+    d.translated_last_name = NameResolver::last_name(
+            c, ctx.last_name, NameResolver::NL_DWARF);
+    d.nick_name = snap.nick_name;
+
+    // profession
+    d.custom_profession = snap.custom_profession;
+    d.raw_profession = peek<BYTE>(c, ctx.profession);
+    Profession *p = gdr->get_profession(d.raw_profession);
+    QString prof_name = tr("Unknown Profession %1").arg(d.raw_profession);
+    if (p) {
+        d.can_set_labors = p->can_assign_labors();
+        prof_name = p->name(d.is_male);
+    } else {
+        warnings << tr("Read unknown profession with id '%1' for dwarf '%2'")
+                    .arg(d.raw_profession).arg(d.first_name);
+        d.can_set_labors = false;
+    }
+    d.profession = d.custom_profession.isEmpty() ? prof_name : d.custom_profession;
+
+    // labors, and military prefs which live in the same array
+    d.labors.clear();
+    foreach(Labor *l, gdr->get_ordered_labors()) {
+        d.labors.set(l->labor_id,
+                     peek<BYTE>(c, ctx.labors + l->labor_id) > 0 ? 1 : 0);
+    }
+    // a preference sharing its id with a labor keeps the whole byte
+    foreach(MilitaryPreference *mp, gdr->get_military_preferences()) {
+        d.labors.set(mp->labor_id, peek<BYTE>(c, ctx.labors + mp->labor_id));
+    }
+
+    d.raw_happiness = peek<qint32>(c, ctx.happiness);
+    d.happiness = Dwarf::happiness_from_score(d.raw_happiness);
+
+    // current job
+    // TODO: jobs contain info about materials being used, if we ever get the
+    // material list we could show that in here
+    d.current_sub_job_id.clear();
+    if (snap.job_address) {
+        d.current_job_id = peek<WORD>(snap.job, ctx.job_id);
+        DwarfJob *job = gdr->get_job(d.current_job_id);
+        if (job) {
+            d.current_job = job->description;
+            if (ctx.job_sub_job_id != 0xFFFFFFFF) {
+                d.current_sub_job_id = snap.sub_job_id;
+                if (!job->reactionClass.isEmpty() &&
+                    !d.current_sub_job_id.isEmpty()) {
+                    RawObjectPtr reaction = gdr->get_reaction(
+                            job->reactionClass, d.current_sub_job_id);
+                    if (!reaction.isNull()) {
+                        d.current_job = capitalize(
+                                reaction->get_value("NAME", d.current_job));
+                    }
+                }
+            }
+        } else {
+            d.current_job = tr("Unknown job");
+        }
+    } else {
+        d.current_job_id = -1;
+        bool is_on_break = snap.states.contains(ctx.on_break_value);
+        d.current_job = is_on_break ? tr("On Break") : tr("No Job");
+    }
+
+    // souls (skills and traits)
+    d.soul_count = snap.soul_count;
+    d.first_soul = snap.first_soul;
+    d.total_xp = 0;
+    d.clear_skills();
+    for (int i = 0; i < DwarfData::TRAIT_COUNT; ++i)
+        d.traits[i] = -1;
+    if (snap.soul_count != 1) {
+        warnings << QString("%1 %2 has %3 souls!").arg(d.first_name)
+                    .arg(d.last_name).arg(snap.soul_count);
+    } else {
+        foreach(const QByteArray &entry, snap.skills) {
+            /* type, level, experience, last used counter, rust, rust counter,
+            demotion counter
+            */
+            short skill_id = peek<qint16>(entry, 0x00);
+            if (skill_id < 0 || skill_id >= DwarfData::MAX_SKILLS) {
+                warnings << QString("%1 %2 has unknown skill id %3")
+                            .arg(d.first_name).arg(d.last_name).arg(skill_id);
+                continue;
+            }
+            Skill s(skill_id, peek<qint32>(entry, 0x08),
+                    peek<qint16>(entry, 0x04));
+            d.total_xp += s.actual_exp();
+            d.set_skill(skill_id, s.exp(), s.rating());
+        }
+        for (int i = 0; i < DwarfData::TRAIT_COUNT; ++i) {
+            short val = peek<qint16>(snap.soul, ctx.soul_traits + i * 2);
+            int deviation = qAbs(val - 50); // how far from the norm is this trait?
+            if (deviation <= 10) {
+                val = -1; // this will cause median scores to not be treated as "active" traits
+            }
+            d.traits[i] = val;
+        }
+    }
+
+    d.squad_ref_id = peek<qint32>(c, ctx.squad_ref_id);
+    d.turn_count = peek<qint32>(c, ctx.turn_count);
+}
+
+void DwarfDecoder::decode_job(DwarfDecodeJob &job) {
+    decode(job.snapshot, *job.ctx, job.data, job.warnings);
+}
+
+void DwarfDecoder::intern_strings(DwarfData &d) {
+    d.first_name = StringPool::intern(d.first_name);
+    d.nick_name = StringPool::intern(d.nick_name);
+    d.last_name = StringPool::intern(d.last_name);
+    d.translated_last_name = StringPool::intern(d.translated_last_name);
+    d.custom_profession = StringPool::intern(d.custom_profession);
+    d.profession = StringPool::intern(d.profession);
+    d.current_job = StringPool::intern(d.current_job);
+    d.current_sub_job_id = StringPool::intern(d.current_sub_job_id);
+}
@@ -87,8 +87,8 @@ void DwarfDetailsWidget::show_dwarf(Dwarf *d) {
     m_cleanup_list.clear();
 
     // SKILLS TABLE
-    QVector<Skill> *skills = d->get_skills();
-    QTableWidget *tw = new QTableWidget(skills->size(), 3, this);
+    QVector<Skill> skills = d->get_skills();
+    QTableWidget *tw = new QTableWidget(skills.size(), 3, this);
     ui->vbox_main->addWidget(tw, 10);
     m_cleanup_list << tw;
     tw->setEditTriggers(QTableWidget::NoEditTriggers);
@@ -100,9 +100,9 @@ void DwarfDetailsWidget::show_dwarf(Dwarf *d) {
     tw->horizontalHeader()->setResizeMode(0, QHeaderView::ResizeToContents);
     tw->horizontalHeader()->setResizeMode(1, QHeaderView::ResizeToContents);
     tw->setSortingEnabled(false); // no sorting while we're inserting
-    for (int row = 0; row < skills->size(); ++row) {
+    for (int row = 0; row < skills.size(); ++row) {
         tw->setRowHeight(row, 18);
-        Skill s = skills->at(row);
+        Skill s = skills.at(row);
         QTableWidgetItem *text = new QTableWidgetItem(s.name());
         QTableWidgetItem *level = new QTableWidgetItem;
         level->setData(0, d->get_rating_by_skill(s.id()));
@@ -123,7 +123,6 @@ void DwarfDetailsWidget::show_dwarf(Dwarf *d) {
 
 
     // TRAITS TABLE
-    QHash<int, short> traits = d->traits();
     QTableWidget *tw_traits = new QTableWidget(this);
     ui->vbox_main->addWidget(tw_traits, 10);
     m_cleanup_list << tw_traits;
@@ -139,8 +138,8 @@ void DwarfDetailsWidget::show_dwarf(Dwarf *d) {
     tw_traits->horizontalHeader()->setResizeMode(0, QHeaderView::ResizeToContents);
     tw_traits->horizontalHeader()->setResizeMode(1, QHeaderView::ResizeToContents);
     tw_traits->setSortingEnabled(false);
-    for (int row = 0; row < traits.size(); ++row) {
-        short val = traits[row];
+    for (int row = 0; row < DwarfData::TRAIT_COUNT; ++row) {
+        short val = d->trait(row);
         if (val == -1)
             continue;
         tw_traits->insertRow(0);
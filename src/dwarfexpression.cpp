@@ -0,0 +1,570 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "dwarfexpression.h"
+#include "dwarf.h"
+
+class DwarfExpression::Node {
+public:
+    virtual ~Node() {}
+    virtual double value(Dwarf *d) const = 0;
+    //! fill out[i] with the value for dwarves[i]
+    virtual void values(const QList<Dwarf*> &dwarves, double *out) const = 0;
+};
+
+namespace {
+    typedef enum {
+        OP_OR,
+        OP_AND,
+        OP_EQ,
+        OP_NE,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_NOT,
+        OP_NEG
+    } EXPRESSION_OP;
+
+    typedef enum {
+        F_HAPPINESS,
+        F_HAPPINESS_LEVEL,
+        F_PROFESSION,
+        F_SQUAD,
+        F_STRENGTH,
+        F_AGILITY,
+        F_TOUGHNESS,
+        F_ID,
+        F_SKILL_LEVELS,
+        F_LEGENDARY_SKILLS,
+        F_ASSIGNED_LABORS,
+        F_MIGRATION_WAVE,
+        F_MALE,
+        F_MILITARY,
+        F_CAN_SET_LABORS,
+        // functions taking an id
+        F_SKILL,
+        F_LABOR,
+        F_TRAIT
+    } EXPRESSION_FIELD;
+
+    struct FieldInfo {
+        const char *name;
+        EXPRESSION_FIELD field;
+        DwarfExpression::EXPRESSION_TYPE type;
+        bool takes_id;
+        const char *help;
+    };
+
+    const FieldInfo s_fields[] = {
+        {"happiness", F_HAPPINESS, DwarfExpression::ET_NUMBER, false, "raw happiness score"},
+        {"happiness_level", F_HAPPINESS_LEVEL, DwarfExpression::ET_NUMBER, false, "happiness from 0 (miserable) to 6 (ecstatic)"},
+        {"profession", F_PROFESSION, DwarfExpression::ET_NUMBER, false, "id of the game profession"},
+        {"squad", F_SQUAD, DwarfExpression::ET_NUMBER, false, "squad reference id, -1 for none"},
+        {"strength", F_STRENGTH, DwarfExpression::ET_NUMBER, false, "strength attribute"},
+        {"agility", F_AGILITY, DwarfExpression::ET_NUMBER, false, "agility attribute"},
+        {"toughness", F_TOUGHNESS, DwarfExpression::ET_NUMBER, false, "toughness attribute"},
+        {"id", F_ID, DwarfExpression::ET_NUMBER, false, "unique game id"},
+        {"skill_levels", F_SKILL_LEVELS, DwarfExpression::ET_NUMBER, false, "sum of all skill levels"},
+        {"legendary_skills", F_LEGENDARY_SKILLS, DwarfExpression::ET_NUMBER, false, "number of legendary skills"},
+        {"assigned_labors", F_ASSIGNED_LABORS, DwarfExpression::ET_NUMBER, false, "number of enabled labors"},
+        {"migration_wave", F_MIGRATION_WAVE, DwarfExpression::ET_NUMBER, false, "best guess at the wave the dwarf arrived in"},
+        {"male", F_MALE, DwarfExpression::ET_BOOL, false, "true for males"},
+        {"military", F_MILITARY, DwarfExpression::ET_BOOL, false, "true for military professions"},
+        {"can_set_labors", F_CAN_SET_LABORS, DwarfExpression::ET_BOOL, false, "false for babies, children and nobles"},
+        {"skill", F_SKILL, DwarfExpression::ET_NUMBER, true, "rating in a skill id, -1 if never used"},
+        {"labor", F_LABOR, DwarfExpression::ET_BOOL, true, "true if a labor id is enabled (or pending)"},
+        {"trait", F_TRAIT, DwarfExpression::ET_NUMBER, true, "score in a trait id, -1 if average"}
+    };
+    const int FIELD_COUNT = sizeof(s_fields) / sizeof(s_fields[0]);
+
+    struct BinaryOpInfo {
+        const char *text;
+        int level; // binding strength, higher binds tighter
+        EXPRESSION_OP op;
+    };
+
+    const BinaryOpInfo s_binary_ops[] = {
+        {"||", 0, OP_OR},
+        {"&&", 1, OP_AND},
+        {"==", 2, OP_EQ},
+        {"!=", 2, OP_NE},
+        {"<", 3, OP_LT},
+        {"<=", 3, OP_LE},
+        {">", 3, OP_GT},
+        {">=", 3, OP_GE},
+        {"+", 4, OP_ADD},
+        {"-", 4, OP_SUB},
+        {"*", 5, OP_MUL},
+        {"/", 5, OP_DIV}
+    };
+    const int BINARY_OP_COUNT = sizeof(s_binary_ops) / sizeof(s_binary_ops[0]);
+    const int BINARY_LEVELS = 6;
+
+    //! scratch buffer for a node's operands; only large lists hit the heap
+    typedef QVarLengthArray<double, 512> Column;
+
+    class ConstantNode : public DwarfExpression::Node {
+    public:
+        ConstantNode(double value) : m_value(value) {}
+        double value(Dwarf*) const {return m_value;}
+        void values(const QList<Dwarf*> &dwarves, double *out) const {
+            for (int i = 0; i < dwarves.size(); ++i)
+                out[i] = m_value;
+        }
+    private:
+        double m_value;
+    };
+
+    class FieldNode : public DwarfExpression::Node {
+    public:
+        FieldNode(EXPRESSION_FIELD field, int id = -1)
+            : m_field(field)
+            , m_id(id)
+        {}
+
+        double value(Dwarf *d) const {
+            switch (m_field) {
+                case F_HAPPINESS:           return d->get_raw_happiness();
+                case F_HAPPINESS_LEVEL:     return d->get_happiness();
+                case F_PROFESSION:          return d->raw_profession();
+                case F_SQUAD:               return d->get_squad_ref_id();
+                case F_STRENGTH:            return d->strength();
+                case F_AGILITY:             return d->agility();
+                case F_TOUGHNESS:           return d->toughness();
+                case F_ID:                  return d->id();
+                case F_SKILL_LEVELS:        return d->total_skill_levels();
+                case F_LEGENDARY_SKILLS:    return d->legendary_skills();
+                case F_ASSIGNED_LABORS:     return d->total_assigned_labors();
+                case F_MIGRATION_WAVE:      return d->migration_wave();
+                case F_MALE:                return d->is_male();
+                case F_MILITARY:            return d->active_military();
+                case F_CAN_SET_LABORS:      return d->can_set_labors();
+                case F_SKILL:               return d->get_rating_by_skill(m_id);
+                case F_LABOR:               return d->labor_enabled(m_id);
+                case F_TRAIT:               return d->trait(m_id);
+            }
+            return 0;
+        }
+
+        void values(const QList<Dwarf*> &dwarves, double *out) const {
+            for (int i = 0; i < dwarves.size(); ++i)
+                out[i] = value(dwarves.at(i));
+        }
+
+    private:
+        EXPRESSION_FIELD m_field;
+        int m_id; // skill, labor or trait id for the functions
+    };
+
+    class UnaryNode : public DwarfExpression::Node {
+    public:
+        UnaryNode(EXPRESSION_OP op, DwarfExpression::Node *operand)
+            : m_op(op)
+            , m_operand(operand)
+        {}
+        ~UnaryNode() {delete m_operand;}
+
+        double value(Dwarf *d) const {
+            double v = m_operand->value(d);
+            return m_op == OP_NOT ? (v == 0) : -v;
+        }
+
+        void values(const QList<Dwarf*> &dwarves, double *out) const {
+            m_operand->values(dwarves, out);
+            int n = dwarves.size();
+            if (m_op == OP_NOT) {
+                for (int i = 0; i < n; ++i)
+                    out[i] = out[i] == 0;
+            } else {
+                for (int i = 0; i < n; ++i)
+                    out[i] = -out[i];
+            }
+        }
+
+    private:
+        EXPRESSION_OP m_op;
+        DwarfExpression::Node *m_operand;
+    };
+
+    class BinaryNode : public DwarfExpression::Node {
+    public:
+        BinaryNode(EXPRESSION_OP op, DwarfExpression::Node *lhs, DwarfExpression::Node *rhs)
+            : m_op(op)
+            , m_lhs(lhs)
+            , m_rhs(rhs)
+        {}
+        ~BinaryNode() {delete m_lhs; delete m_rhs;}
+
+        double value(Dwarf *d) const {
+            double l = m_lhs->value(d);
+            // short circuit like C does, the right side may be expensive
+            if (m_op == OP_AND && l == 0)
+                return 0;
+            if (m_op == OP_OR && l != 0)
+                return 1;
+            return apply(l, m_rhs->value(d));
+        }
+
+        void values(const QList<Dwarf*> &dwarves, double *out) const {
+            int n = dwarves.size();
+            Column rhs(n);
+            m_lhs->values(dwarves, out);
+            m_rhs->values(dwarves, rhs.data());
+            // one tight loop per operator instead of a switch per dwarf
+            switch (m_op) {
+                case OP_OR:  for (int i = 0; i < n; ++i) out[i] = out[i] != 0 || rhs[i] != 0; break;
+                case OP_AND: for (int i = 0; i < n; ++i) out[i] = out[i] != 0 && rhs[i] != 0; break;
+                case OP_EQ:  for (int i = 0; i < n; ++i) out[i] = out[i] == rhs[i]; break;
+                case OP_NE:  for (int i = 0; i < n; ++i) out[i] = out[i] != rhs[i]; break;
+                case OP_LT:  for (int i = 0; i < n; ++i) out[i] = out[i] < rhs[i]; break;
+                case OP_LE:  for (int i = 0; i < n; ++i) out[i] = out[i] <= rhs[i]; break;
+                case OP_GT:  for (int i = 0; i < n; ++i) out[i] = out[i] > rhs[i]; break;
+                case OP_GE:  for (int i = 0; i < n; ++i) out[i] = out[i] >= rhs[i]; break;
+                case OP_ADD: for (int i = 0; i < n; ++i) out[i] += rhs[i]; break;
+                case OP_SUB: for (int i = 0; i < n; ++i) out[i] -= rhs[i]; break;
+                case OP_MUL: for (int i = 0; i < n; ++i) out[i] *= rhs[i]; break;
+                default:     for (int i = 0; i < n; ++i) out[i] = apply(out[i], rhs[i]); break;
+            }
+        }
+
+    private:
+        EXPRESSION_OP m_op;
+        DwarfExpression::Node *m_lhs;
+        DwarfExpression::Node *m_rhs;
+
+        double apply(double l, double r) const {
+            switch (m_op) {
+                case OP_OR:     return l != 0 || r != 0;
+                case OP_AND:    return l != 0 && r != 0;
+                case OP_EQ:     return l == r;
+                case OP_NE:     return l != r;
+                case OP_LT:     return l < r;
+                case OP_LE:     return l <= r;
+                case OP_GT:     return l > r;
+                case OP_GE:     return l >= r;
+                case OP_ADD:    return l + r;
+                case OP_SUB:    return l - r;
+                case OP_MUL:    return l * r;
+                case OP_DIV:    return r == 0 ? 0 : l / r; // keep sort keys and cells finite
+                default:        return 0;
+            }
+        }
+    };
+
+    //! recursive descent parser producing a type checked node tree
+    class ExpressionParser {
+    public:
+        ExpressionParser(const QString &text)
+            : m_text(text)
+            , m_pos(0)
+            , m_token_pos(0)
+            , m_kind(TK_END)
+        {
+            next();
+        }
+
+        DwarfExpression::Node *parse(DwarfExpression::EXPRESSION_TYPE &type) {
+            DwarfExpression::Node *root = parse_level(0, type);
+            if (root && m_kind != TK_END) {
+                fail(QObject::tr("Unexpected '%1'").arg(m_token));
+                delete root;
+                root = 0;
+            }
+            return root;
+        }
+
+        const QString &error() const {return m_error;}
+
+    private:
+        typedef enum {
+            TK_END,
+            TK_NUMBER,
+            TK_NAME,
+            TK_SYMBOL,
+            TK_UNKNOWN
+        } TOKEN_KIND;
+
+        QString m_text;
+        int m_pos;
+        int m_token_pos;
+        TOKEN_KIND m_kind;
+        QString m_token;
+        QString m_error;
+
+        void next() {
+            int len = m_text.length();
+            while (m_pos < len && m_text.at(m_pos).isSpace())
+                ++m_pos;
+            m_token_pos = m_pos;
+            if (m_pos >= len) {
+                m_kind = TK_END;
+                m_token.clear();
+                return;
+            }
+            QChar c = m_text.at(m_pos);
+            if (c.isDigit() || c == '.') {
+                while (m_pos < len && (m_text.at(m_pos).isDigit() || m_text.at(m_pos) == '.'))
+                    ++m_pos;
+                m_kind = TK_NUMBER;
+            } else if (c.isLetter() || c == '_') {
+                while (m_pos < len && (m_text.at(m_pos).isLetterOrNumber() || m_text.at(m_pos) == '_'))
+                    ++m_pos;
+                m_kind = TK_NAME;
+            } else {
+                static const char *two_char[] = {"||", "&&", "==", "!=", "<=", ">="};
+                m_kind = TK_UNKNOWN;
+                for (int i = 0; i < 6; ++i) {
+                    if (m_text.midRef(m_pos, 2) == QLatin1String(two_char[i])) {
+                        m_pos += 2;
+                        m_kind = TK_SYMBOL;
+                        break;
+                    }
+                }
+                if (m_kind == TK_UNKNOWN) {
+                    if (QString("<>+-*/!()").contains(c))
+                        m_kind = TK_SYMBOL;
+                    ++m_pos;
+                }
+            }
+            m_token = m_text.mid(m_token_pos, m_pos - m_token_pos);
+        }
+
+        bool at_symbol(const char *symbol) const {
+            return m_kind == TK_SYMBOL && m_token == QLatin1String(symbol);
+        }
+
+        void fail(const QString &msg) {
+            if (m_error.isEmpty())
+                m_error = QObject::tr("%1 at position %2").arg(msg).arg(m_token_pos + 1);
+        }
+
+        static QString type_name(DwarfExpression::EXPRESSION_TYPE type) {
+            return type == DwarfExpression::ET_BOOL ? QObject::tr("true/false") : QObject::tr("number");
+        }
+
+        //! result type of a binary operator, ET_INVALID if the operands don't fit it
+        static DwarfExpression::EXPRESSION_TYPE result_type(int level,
+                                                            DwarfExpression::EXPRESSION_TYPE lhs,
+                                                            DwarfExpression::EXPRESSION_TYPE rhs) {
+            switch (level) {
+                case 0: // || &&
+                case 1:
+                    if (lhs == DwarfExpression::ET_BOOL && rhs == DwarfExpression::ET_BOOL)
+                        return DwarfExpression::ET_BOOL;
+                    break;
+                case 2: // == != compare anything of the same type
+                    if (lhs == rhs)
+                        return DwarfExpression::ET_BOOL;
+                    break;
+                case 3: // ordering
+                    if (lhs == DwarfExpression::ET_NUMBER && rhs == DwarfExpression::ET_NUMBER)
+                        return DwarfExpression::ET_BOOL;
+                    break;
+                default: // arithmetic
+                    if (lhs == DwarfExpression::ET_NUMBER && rhs == DwarfExpression::ET_NUMBER)
+                        return DwarfExpression::ET_NUMBER;
+                    break;
+            }
+            return DwarfExpression::ET_INVALID;
+        }
+
+        DwarfExpression::Node *parse_level(int level, DwarfExpression::EXPRESSION_TYPE &type) {
+            if (level == BINARY_LEVELS)
+                return parse_unary(type);
+
+            DwarfExpression::Node *lhs = parse_level(level + 1, type);
+            while (lhs && m_kind == TK_SYMBOL) {
+                const BinaryOpInfo *info = 0;
+                for (int i = 0; i < BINARY_OP_COUNT; ++i) {
+                    if (s_binary_ops[i].level == level && at_symbol(s_binary_ops[i].text)) {
+                        info = &s_binary_ops[i];
+                        break;
+                    }
+                }
+                if (!info)
+                    break;
+                QString op_text = m_token;
+                next();
+
+                DwarfExpression::EXPRESSION_TYPE rhs_type;
+                DwarfExpression::Node *rhs = parse_level(level + 1, rhs_type);
+                if (!rhs) {
+                    delete lhs;
+                    return 0;
+                }
+                DwarfExpression::EXPRESSION_TYPE result = result_type(level, type, rhs_type);
+                if (result == DwarfExpression::ET_INVALID) {
+                    fail(QObject::tr("'%1' can't be used between a %2 and a %3")
+                         .arg(op_text).arg(type_name(type)).arg(type_name(rhs_type)));
+                    delete lhs;
+                    delete rhs;
+                    return 0;
+                }
+                lhs = new BinaryNode(info->op, lhs, rhs);
+                type = result;
+            }
+            return lhs;
+        }
+
+        DwarfExpression::Node *parse_unary(DwarfExpression::EXPRESSION_TYPE &type) {
+            if (at_symbol("!") || at_symbol("-")) {
+                bool is_not = at_symbol("!");
+                DwarfExpression::EXPRESSION_TYPE wanted = is_not ? DwarfExpression::ET_BOOL
+                                                                 : DwarfExpression::ET_NUMBER;
+                next();
+                DwarfExpression::Node *operand = parse_unary(type);
+                if (!operand)
+                    return 0;
+                if (type != wanted) {
+                    fail(QObject::tr("'%1' needs a %2").arg(is_not ? "!" : "-").arg(type_name(wanted)));
+                    delete operand;
+                    return 0;
+                }
+                return new UnaryNode(is_not ? OP_NOT : OP_NEG, operand);
+            }
+            return parse_primary(type);
+        }
+
+        DwarfExpression::Node *parse_primary(DwarfExpression::EXPRESSION_TYPE &type) {
+            if (m_kind == TK_NUMBER) {
+                bool ok;
+                double v = m_token.toDouble(&ok);
+                if (!ok) {
+                    fail(QObject::tr("Bad number '%1'").arg(m_token));
+                    return 0;
+                }
+                next();
+                type = DwarfExpression::ET_NUMBER;
+                return new ConstantNode(v);
+            }
+            if (at_symbol("(")) {
+                next();
+                DwarfExpression::Node *inner = parse_level(0, type);
+                if (inner && !at_symbol(")")) {
+                    fail(QObject::tr("Missing ')'"));
+                    delete inner;
+                    return 0;
+                }
+                next();
+                return inner;
+            }
+            if (m_kind != TK_NAME) {
+                fail(m_kind == TK_END ? QObject::tr("Unexpected end")
+                                      : QObject::tr("Unexpected '%1'").arg(m_token));
+                return 0;
+            }
+
+            QString name = m_token.toLower();
+            if (name == "true" || name == "false") {
+                next();
+                type = DwarfExpression::ET_BOOL;
+                return new ConstantNode(name == "true");
+            }
+            const FieldInfo *info = 0;
+            for (int i = 0; i < FIELD_COUNT; ++i) {
+                if (name == QLatin1String(s_fields[i].name)) {
+                    info = &s_fields[i];
+                    break;
+                }
+            }
+            if (!info) {
+                fail(QObject::tr("Unknown name '%1'").arg(m_token));
+                return 0;
+            }
+            next();
+            type = info->type;
+            if (!info->takes_id)
+                return new FieldNode(info->field);
+
+            // ids are literal so they can be checked (and bound) right here
+            if (!at_symbol("(")) {
+                fail(QObject::tr("'%1' needs an id, like %1(0)").arg(name));
+                return 0;
+            }
+            next();
+            bool ok = false;
+            int id = m_kind == TK_NUMBER ? m_token.toInt(&ok) : -1;
+            if (!ok) {
+                fail(QObject::tr("'%1' needs a whole number id").arg(name));
+                return 0;
+            }
+            next();
+            if (!at_symbol(")")) {
+                fail(QObject::tr("Missing ')'"));
+                return 0;
+            }
+            next();
+            return new FieldNode(info->field, id);
+        }
+    };
+}
+
+DwarfExpression::DwarfExpression()
+    : m_type(ET_INVALID)
+{}
+
+DwarfExpression::DwarfExpression(const QString &text)
+    : m_text(text)
+    , m_type(ET_INVALID)
+{
+    ExpressionParser parser(text);
+    EXPRESSION_TYPE type = ET_INVALID;
+    Node *root = parser.parse(type);
+    if (root) {
+        m_root = QSharedPointer<const Node>(root);
+        m_type = type;
+    } else {
+        m_error = parser.error();
+    }
+}
+
+double DwarfExpression::value(Dwarf *d) const {
+    if (!m_root)
+        return 0;
+    return m_root->value(d);
+}
+
+QVector<double> DwarfExpression::values(const QList<Dwarf*> &dwarves) const {
+    QVector<double> ret_val(dwarves.size(), 0);
+    if (m_root && !dwarves.isEmpty())
+        m_root->values(dwarves, ret_val.data());
+    return ret_val;
+}
+
+QString DwarfExpression::help_text() {
+    QString ret_val = "<b>Expression Reference</b><table border=1 cellpadding=3 cellspacing=0 width=100%>"
+        "<tr><th width=24%>Name</th><th>Value</th></tr>";
+    for (int i = 0; i < FIELD_COUNT; ++i) {
+        QString name = s_fields[i].name;
+        if (s_fields[i].takes_id)
+            name += "(id)";
+        ret_val.append(QString("<tr><td><font color=blue>%1</font></td><td>%2</td></tr>")
+                       .arg(name).arg(s_fields[i].help));
+    }
+    ret_val.append("</table>");
+    return ret_val;
+}
@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "dfinstance.h"
 #include "memorylayout.h"
 #include "truncatingfilelogger.h"
+#include "gamedatacache.h"
+#include "nameresolver.h"
 
 DwarfTherapist::DwarfTherapist(int &argc, char **argv)
     : QApplication(argc, argv)
@@ -135,6 +137,7 @@ void DwarfTherapist::read_settings() {
     } else {
         m_main_window->get_toolbar()->setToolButtonStyle(Qt::ToolButtonIconOnly);
     }
+    Dwarf::read_settings();
 
     foreach(CustomProfession *cp, m_custom_professions) {
         cp->deleteLater();
@@ -319,6 +322,29 @@ void DwarfTherapist::load_game_translation_tables(DFInstance *df) {
     m_language.clear();
     m_generic_words.clear();
     m_dwarf_words.clear();
+    NameResolver::clear(); // names built from the old tables are stale
+
+    // these only change with DF itself or its raws, so reconnecting to the
+    // same game can skip reading them
+    GameDataCache cache(df, "words");
+    if (cache.load()) {
+        QDataStream &in = cache.stream();
+        qint32 word_count = 0;
+        in >> m_generic_words >> m_dwarf_words >> word_count;
+        for (int i = 0; i < word_count && in.status() == QDataStream::Ok; ++i) {
+            m_language << Word::load(df, in);
+        }
+        if (in.status() == QDataStream::Ok) {
+            LOGD << "loaded" << m_generic_words.size() << "generic and"
+                    << m_dwarf_words.size() << "dwarf words from cache";
+            return;
+        }
+        LOGW << "game data cache for words is corrupt, re-reading";
+        qDeleteAll(m_language);
+        m_language.clear();
+        m_generic_words.clear();
+        m_dwarf_words.clear();
+    }
 
     uint generic_lang_table = df->memory_layout()->address("language_vector") + df->get_memory_correction();
     uint translation_vector = df->memory_layout()->address("translation_vector") + df->get_memory_correction();
@@ -332,19 +358,23 @@ void DwarfTherapist::load_game_translation_tables(DFInstance *df) {
         LOGD << "Loading generic strings from" << hex << generic_lang_table;
         QVector<uint> generic_words = df->enumerate_vector(generic_lang_table);
         LOGD << "generic words" << generic_words.size();
-        foreach(uint word_ptr, generic_words) {
-            m_generic_words << df->read_string(word_ptr);
-            m_language << Word::get_word(df, word_ptr);
+        m_language = Word::get_words(df, generic_words);
+        // a word's base is the string at the front of its struct, already
+        // read along with its other members
+        m_generic_words.reserve(m_language.size());
+        foreach(Word *w, m_language) {
+            m_generic_words << w->base();
         }
     }
 
     if (translation_vector != 0xFFFFFFFF && translation_vector != 0) {
         QVector<uint> languages = df->enumerate_vector(translation_vector);
+        QVector<QString> race_names = df->read_strings(languages);
         uint dwarf_entry = 0;
-        foreach(uint lang, languages) {
-            QString race_name = df->read_string(lang);
-            LOGD << "FOUND LANG ENTRY" << hex << lang << race_name;
-            if (race_name == "DWARF")
+        for (int i = 0; i < languages.size(); ++i) {
+            uint lang = languages.at(i);
+            LOGD << "FOUND LANG ENTRY" << hex << lang << race_names.at(i);
+            if (race_names.at(i) == "DWARF")
                 dwarf_entry = lang;
         }
         uint dwarf_lang_table = dwarf_entry + word_table_offset - df->VECTOR_POINTER_OFFSET;
@@ -352,9 +382,18 @@ void DwarfTherapist::load_game_translation_tables(DFInstance *df) {
         QVector<uint> dwarf_words = df->enumerate_vector(dwarf_lang_table);
         LOGD << "dwarf words" << dwarf_words.size();
 
-        foreach(uint word_ptr, dwarf_words) {
-            m_dwarf_words << df->read_string(word_ptr);
-        }
+        m_dwarf_words = df->read_strings(dwarf_words);
     }
     df->detach();
+    if (m_generic_words.isEmpty() && m_dwarf_words.isEmpty())
+        return; // nothing worth caching
+
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(GameDataCache::stream_version());
+    out << m_generic_words << m_dwarf_words << (qint32)m_language.size();
+    foreach(Word *w, m_language) {
+        w->save(out);
+    }
+    cache.save(payload);
 }
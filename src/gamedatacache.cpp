@@ -0,0 +1,136 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include <QtGui>
+#include "gamedatacache.h"
+#include "dfinstance.h"
+#include "memorylayout.h"
+#include "truncatingfilelogger.h"
+
+static const quint32 CACHE_MAGIC = 0x44544743; // "DTGC"
+
+GameDataCache::GameDataCache(DFInstance *df, const QString &section)
+    : m_key(build_key(df))
+    , m_map(0)
+{
+    QString checksum = df->memory_layout()->checksum().toLower();
+    m_file.setFileName(QDir(cache_dir()).filePath(
+            QString("%1-%2.cache").arg(checksum, section)));
+    m_stream.setVersion(stream_version());
+}
+
+GameDataCache::~GameDataCache() {
+    m_stream.setDevice(0);
+    m_buffer.close();
+    if (m_map)
+        m_file.unmap(m_map);
+    m_file.close();
+}
+
+QString GameDataCache::cache_dir() {
+    QString path = QDesktopServices::storageLocation(
+            QDesktopServices::CacheLocation);
+    if (path.isEmpty())
+        path = QDir::current().absoluteFilePath("cache");
+    return path;
+}
+
+QDateTime GameDataCache::newest_file(const QDir &dir) {
+    QDateTime newest;
+    foreach(QFileInfo fi, dir.entryInfoList(QDir::Files)) {
+        if (newest.isNull() || fi.lastModified() > newest)
+            newest = fi.lastModified();
+    }
+    return newest;
+}
+
+QString GameDataCache::build_key(DFInstance *df) {
+    // DF reads raws from its install, and each world keeps its own copy
+    QDir df_dir = df->get_df_dir();
+    QDateTime newest = newest_file(QDir(df_dir.filePath("raw/objects")));
+    QDir saves(df_dir.filePath("data/save"));
+    foreach(QString world, saves.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QDateTime t = newest_file(QDir(saves.filePath(world + "/raw/objects")));
+        if (newest.isNull() || t > newest)
+            newest = t;
+    }
+    return QString("%1|%2").arg(df->memory_layout()->checksum().toLower())
+            .arg(newest.isNull() ? 0 : newest.toTime_t());
+}
+
+bool GameDataCache::load() {
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+        return false;
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map) {
+        LOGW << "unable to map game data cache" << m_file.fileName()
+                << m_file.errorString();
+        return false;
+    }
+    // the buffer only wraps the mapping, nothing is copied
+    m_buffer.setData(QByteArray::fromRawData(
+            reinterpret_cast<const char*>(m_map), m_file.size()));
+    m_buffer.open(QIODevice::ReadOnly);
+    m_stream.setDevice(&m_buffer);
+
+    quint32 magic = 0, version = 0;
+    QString key;
+    m_stream >> magic >> version >> key;
+    if (m_stream.status() != QDataStream::Ok || magic != CACHE_MAGIC ||
+        version != FORMAT_VERSION || key != m_key) {
+        LOGD << "game data cache" << m_file.fileName() << "is stale";
+        return false;
+    }
+    LOGD << "using game data cache" << m_file.fileName();
+    return true;
+}
+
+bool GameDataCache::save(const QByteArray &payload) {
+    QDir().mkpath(cache_dir());
+    QString tmp_name = m_file.fileName() + ".tmp";
+    QFile out(tmp_name);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOGW << "unable to write game data cache" << tmp_name
+                << out.errorString();
+        return false;
+    }
+    QDataStream s(&out);
+    s.setVersion(stream_version());
+    s << CACHE_MAGIC << FORMAT_VERSION << m_key;
+    s.writeRawData(payload.constData(), payload.size());
+    out.close();
+
+    // swap the new file in, the old one may still be mapped by load()
+    if (m_map) {
+        m_stream.setDevice(0);
+        m_buffer.close();
+        m_file.unmap(m_map);
+        m_map = 0;
+    }
+    m_file.close();
+    QFile::remove(m_file.fileName());
+    if (!QFile::rename(tmp_name, m_file.fileName())) {
+        LOGW << "unable to replace game data cache" << m_file.fileName();
+        return false;
+    }
+    return true;
+}
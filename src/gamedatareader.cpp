@@ -44,7 +44,13 @@ GameDataReader::GameDataReader(QObject *parent)
         m_data_settings->setArrayIndex(i);
         Labor *l = new Labor(*m_data_settings, this);
         m_labors.insert(l->labor_id, l);
+        m_labor_ids.set(l->labor_id);
         labor_names << l->name;
+        if (l->labor_id >= 0) {
+            while (m_labor_skills.size() <= l->labor_id)
+                m_labor_skills << -1;
+            m_labor_skills[l->labor_id] = l->skill_id;
+        }
     }
     m_data_settings->endArray();
     m_ordered_labors.clear();
@@ -152,6 +158,7 @@ GameDataReader::GameDataReader(QObject *parent)
         m_data_settings->setArrayIndex(i);
         MilitaryPreference *p = new MilitaryPreference(*m_data_settings, this);
         m_military_preferences.insert(p->labor_id, p);
+        m_military_preference_ids.set(p->labor_id);
     }
     m_data_settings->endArray();
 
@@ -258,5 +265,39 @@ void GameDataReader::read_raws(QDir df_dir) {
     LOGD << "Read " << m_reaction_classes["reaction_other"].size() << " reactions";
 }
 
+void GameDataReader::save_raws(QDataStream &out) {
+    out << (qint32)m_reaction_classes.size();
+    foreach(QString reaction_class, m_reaction_classes.uniqueKeys()) {
+        const QRawObjectList &objects = m_reaction_classes[reaction_class];
+        out << reaction_class << (qint32)objects.size();
+        foreach(RawObjectPtr obj, objects) {
+            obj->save(out);
+        }
+    }
+}
+
+bool GameDataReader::load_raws(QDataStream &in) {
+    QHash<QString, QRawObjectList> reaction_classes;
+    qint32 class_count = 0;
+    in >> class_count;
+    for (int i = 0; i < class_count && in.status() == QDataStream::Ok; ++i) {
+        QString reaction_class;
+        qint32 count = 0;
+        in >> reaction_class >> count;
+        QRawObjectList &objects = reaction_classes[reaction_class];
+        for (int j = 0; j < count && in.status() == QDataStream::Ok; ++j) {
+            RawObjectPtr obj(new RawObject);
+            obj->load(in);
+            objects.append(obj);
+        }
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+    m_reaction_classes = reaction_classes;
+    LOGD << "Loaded" << m_reaction_classes.value("reaction_other").size()
+            << "reactions from cache";
+    return true;
+}
+
 
 GameDataReader *GameDataReader::m_instance = 0;
@@ -51,8 +51,11 @@ AttributeColumn::AttributeColumn(const AttributeColumn &to_copy)
     , m_attribute_type(to_copy.m_attribute_type)
 {}
 
-QStandardItem *AttributeColumn::build_cell(Dwarf *d) {
-    QStandardItem *item = init_cell(d);
+QVariant AttributeColumn::cell_data(Dwarf *d, int role) {
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole &&
+        role != DwarfModel::DR_SORT_VALUE && role != DwarfModel::DR_RATING)
+        return ViewColumn::cell_data(d, role);
+
     QString key("attributes/%1/level_%2");
     short val = -1;
     switch (m_attribute_type) {
@@ -71,29 +74,17 @@ QStandardItem *AttributeColumn::build_cell(Dwarf *d) {
         default:
             LOGW << "Attribute column can't build cell since type is set to" << m_attribute_type;
     }
+    if (role == Qt::DisplayRole)
+        return val ? QVariant(val) : QVariant();
+    if (role != Qt::ToolTipRole)
+        return val;
+
     QString msg;
-    if (val) {
+    if (val)
         msg = GameDataReader::ptr()->get_string_for_key(key);
-        item->setData(val, Qt::DisplayRole);
-    }
-
-    item->setData(val, DwarfModel::DR_SORT_VALUE);
-    item->setData(val, DwarfModel::DR_RATING);
-    item->setData(CT_ATTRIBUTE, DwarfModel::DR_COL_TYPE);
-
-    QString tooltip = QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
+    return QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
         .arg(m_title)
         .arg(msg)
         .arg(val)
         .arg(d->nice_name());
-    item->setToolTip(tooltip);
-    return item;
-}
-
-QStandardItem *AttributeColumn::build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves) {
-    Q_UNUSED(group_name);
-    Q_UNUSED(dwarves);
-    QStandardItem *item = new QStandardItem;
-    item->setData(m_bg_color, DwarfModel::DR_DEFAULT_BG_COLOR);
-    return item;
 }
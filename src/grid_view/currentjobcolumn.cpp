@@ -40,8 +40,31 @@ CurrentJobColumn::CurrentJobColumn(const CurrentJobColumn &to_copy)
     : ViewColumn(to_copy)
 {}
 
-QStandardItem *CurrentJobColumn::build_cell(Dwarf *d) {
-    QStandardItem *item = init_cell(d);
+QVariant CurrentJobColumn::cell_data(Dwarf *d, int role) {
+    switch (role) {
+        case Qt::DecorationRole:
+            {
+                // icons are shared by every dwarf doing the same kind of job
+                static QHash<QString, QIcon> icons;
+                QString pixmap_name = job_pixmap_name(d);
+                if (!icons.contains(pixmap_name))
+                    icons.insert(pixmap_name, QIcon(pixmap_name));
+                return icons.value(pixmap_name);
+            }
+        case DwarfModel::DR_SORT_VALUE:
+            return d->current_job_id();
+        case Qt::ToolTipRole:
+            return QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
+                .arg(m_title)
+                .arg(d->current_job())
+                .arg(d->current_job_id())
+                .arg(d->nice_name());
+        default:
+            return ViewColumn::cell_data(d, role);
+    }
+}
+
+QString CurrentJobColumn::job_pixmap_name(Dwarf *d) {
     short job_id = d->current_job_id();
     QString pixmap_name(":img/help.png");
     if (job_id == -1) {
@@ -59,8 +82,6 @@ QStandardItem *CurrentJobColumn::build_cell(Dwarf *d) {
                 }
             }
 
-            TRACE << "Dwarf: " << d->nice_name() << " job -" << job_id << ": (" << job->description << "," << job_type << ")";
-
             switch (job_type) {
             case DwarfJob::DJT_IDLE:
                 pixmap_name = ":status/img/bullet_red.png";
@@ -120,24 +141,5 @@ QStandardItem *CurrentJobColumn::build_cell(Dwarf *d) {
             }
         }
     }
-    item->setData(QIcon(pixmap_name), Qt::DecorationRole);
-    
-    item->setData(CT_IDLE, DwarfModel::DR_COL_TYPE);
-    item->setData(d->current_job_id(), DwarfModel::DR_SORT_VALUE);
-    QString tooltip = QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
-        .arg(m_title)
-        .arg(d->current_job())
-        .arg(d->current_job_id())
-        .arg(d->nice_name());
-    item->setToolTip(tooltip);
-    return item;
-}
-
-QStandardItem *CurrentJobColumn::build_aggregate(const QString &group_name,
-                                           const QVector<Dwarf*> &dwarves) {
-    Q_UNUSED(group_name);
-    Q_UNUSED(dwarves);
-    QStandardItem *item = new QStandardItem;
-    item->setData(m_bg_color, DwarfModel::DR_DEFAULT_BG_COLOR);
-    return item;
+    return pixmap_name;
 }
@@ -0,0 +1,74 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "expressioncolumn.h"
+#include "columntypes.h"
+#include "viewcolumnset.h"
+#include "dwarfmodel.h"
+#include "dwarf.h"
+
+ExpressionColumn::ExpressionColumn(const QString &title, const QString &expression, ViewColumnSet *set, QObject *parent)
+    : ViewColumn(title, CT_EXPRESSION, set, parent)
+    , m_expression(expression)
+{}
+
+ExpressionColumn::ExpressionColumn(QSettings &s, ViewColumnSet *set, QObject *parent)
+    : ViewColumn(s, set, parent)
+    , m_expression(s.value("expression").toString())
+{}
+
+ExpressionColumn::ExpressionColumn(const ExpressionColumn &to_copy)
+    : ViewColumn(to_copy)
+    , m_expression(to_copy.m_expression)
+{}
+
+QVariant ExpressionColumn::cell_data(Dwarf *d, int role) {
+    switch (role) {
+        case Qt::DisplayRole:
+            {
+                if (!m_expression.is_valid())
+                    return "?";
+                double v = m_expression.value(d);
+                if (m_expression.type() == DwarfExpression::ET_BOOL)
+                    return v ? "X" : QString();
+                return QString::number(v, 'g', 4);
+            }
+        case DwarfModel::DR_SORT_VALUE:
+            return m_expression.value(d);
+        case Qt::ToolTipRole:
+            {
+                QString msg;
+                if (!m_expression.is_valid())
+                    msg = tr("Invalid expression: %1").arg(m_expression.error());
+                else
+                    msg = QString::number(m_expression.value(d));
+                return QString("<h3>%1</h3>%2<br>%3<h4>%4</h4>")
+                    .arg(m_title)
+                    .arg(Qt::escape(m_expression.text()))
+                    .arg(msg)
+                    .arg(d->nice_name());
+            }
+        default:
+            return ViewColumn::cell_data(d, role);
+    }
+}
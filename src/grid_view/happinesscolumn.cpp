@@ -42,24 +42,27 @@ HappinessColumn::HappinessColumn(const HappinessColumn &to_copy)
     , m_colors(to_copy.m_colors)
 {}
 
-QStandardItem *HappinessColumn::build_cell(Dwarf *d) {
-	QStandardItem *item = init_cell(d);
-	
-	item->setData(CT_HAPPINESS, DwarfModel::DR_COL_TYPE);
-	item->setData(d->get_raw_happiness(), DwarfModel::DR_SORT_VALUE);
-	QString tooltip = QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
-					  .arg(m_title)
-					  .arg(Dwarf::happiness_name(d->get_happiness()))
-					  .arg(d->get_raw_happiness())
-					  .arg(d->nice_name());
-	item->setToolTip(tooltip);
-	QColor bg = m_colors[d->get_happiness()];
-	item->setBackground(QBrush(bg));
-	return item;
+QVariant HappinessColumn::cell_data(Dwarf *d, int role) {
+	switch (role) {
+		case DwarfModel::DR_SORT_VALUE:
+			return d->get_raw_happiness();
+		case Qt::BackgroundColorRole:
+			return m_colors[d->get_happiness()];
+		case Qt::ToolTipRole:
+			return QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
+				.arg(m_title)
+				.arg(Dwarf::happiness_name(d->get_happiness()))
+				.arg(d->get_raw_happiness())
+				.arg(d->nice_name());
+		default:
+			return ViewColumn::cell_data(d, role);
+	}
 }
 
-QStandardItem *HappinessColumn::build_aggregate(const QString &, const QVector<Dwarf*> &dwarves) {
-	QStandardItem *item = new QStandardItem;
+QVariant HappinessColumn::aggregate_data(const QString &group_name, const QVector<Dwarf*> &dwarves, int role) {
+	if (role != Qt::ToolTipRole && role != Qt::BackgroundColorRole && role != DwarfModel::DR_DEFAULT_BG_COLOR)
+		return ViewColumn::aggregate_data(group_name, dwarves, role);
+
 	// find lowest happiness of all dwarfs this set represents, and show that color (so low happiness still pops out in a big group)
 	Dwarf::DWARF_HAPPINESS lowest = Dwarf::DH_ECSTATIC;
 	QString lowest_dwarf = "Nobody";
@@ -70,13 +73,13 @@ QStandardItem *HappinessColumn::build_aggregate(const QString &, const QVector<D
 			lowest_dwarf = d->nice_name();
 		}
 	}
-	item->setToolTip(tr("<h3>%1</h3>Lowest Happiness in group: <b>%2: %3</b>")
-		.arg(m_title)
-		.arg(lowest_dwarf)
-		.arg(Dwarf::happiness_name(lowest)));
-	item->setData(m_colors[lowest], Qt::BackgroundColorRole);
-	item->setData(m_colors[lowest], DwarfModel::DR_DEFAULT_BG_COLOR);
-	return item;
+	if (role == Qt::ToolTipRole) {
+		return tr("<h3>%1</h3>Lowest Happiness in group: <b>%2: %3</b>")
+			.arg(m_title)
+			.arg(lowest_dwarf)
+			.arg(Dwarf::happiness_name(lowest));
+	}
+	return m_colors[lowest];
 }
 
 void HappinessColumn::read_settings() {
@@ -87,12 +90,4 @@ void HappinessColumn::read_settings() {
 		m_colors[h] = s->value(k).value<QColor>();
 	}
 	s->endGroup();
-	redraw_cells();
 }
-
-void HappinessColumn::redraw_cells() {
-	/*foreach(Dwarf *d, m_cells.uniqueKeys()) {
-        if (d && m_cells[d] && m_cells[d]->model())
-		    m_cells[d]->setBackground(m_colors[d->get_happiness()]);
-	}*/
-}
\ No newline at end of file
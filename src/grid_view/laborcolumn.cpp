@@ -46,61 +46,69 @@ LaborColumn::LaborColumn(const LaborColumn &to_copy)
     , m_skill_id(to_copy.m_skill_id)
 {}
 
-QStandardItem *LaborColumn::build_cell(Dwarf *d) {
-	GameDataReader *gdr = GameDataReader::ptr();
-	QStandardItem *item = init_cell(d);
-
-	item->setData(CT_LABOR, DwarfModel::DR_COL_TYPE);
-	short rating = d->get_rating_by_skill(m_skill_id);
-	if (rating < 0 && d->labor_enabled(m_labor_id)) {
-		item->setData(float(rating + 0.5f), DwarfModel::DR_SORT_VALUE); // push assigned labors above no exp in sort order
-	} else {
-		item->setData(rating, DwarfModel::DR_SORT_VALUE);		
-	}
-	item->setData(rating, DwarfModel::DR_RATING);
-	item->setData(m_labor_id, DwarfModel::DR_LABOR_ID);
-	item->setData(m_set->name(), DwarfModel::DR_SET_NAME);
-	
-	QString skill_str;
-	if (m_skill_id != -1 && rating > -1) {
-		QString adjusted_rating = QString::number(rating);
-		if (rating > 15)
-			adjusted_rating = QString("15 +%1").arg(rating - 15);
-		skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
-			.arg(gdr->get_skill_level_name(rating))
-			.arg(gdr->get_skill_name(m_skill_id))
-			.arg(adjusted_rating)
-			.arg(d->get_skill(m_skill_id).exp_summary());
-	} else {
-		// either the skill isn't a valid id, or they have 0 experience in it
-		skill_str = "0 experience";
+QVariant LaborColumn::cell_data(Dwarf *d, int role) {
+	switch (role) {
+		case DwarfModel::DR_SORT_VALUE:
+			{
+				short rating = d->get_rating_by_skill(m_skill_id);
+				if (rating < 0 && d->labor_enabled(m_labor_id))
+					return float(rating + 0.5f); // push assigned labors above no exp in sort order
+				return rating;
+			}
+		case DwarfModel::DR_RATING:
+			return d->get_rating_by_skill(m_skill_id);
+		case DwarfModel::DR_LABOR_ID:
+			return m_labor_id;
+		case DwarfModel::DR_SET_NAME:
+			return m_set->name();
+		case Qt::ToolTipRole:
+			{
+				GameDataReader *gdr = GameDataReader::ptr();
+				short rating = d->get_rating_by_skill(m_skill_id);
+				QString skill_str;
+				if (m_skill_id != -1 && rating > -1) {
+					QString adjusted_rating = QString::number(rating);
+					if (rating > 15)
+						adjusted_rating = QString("15 +%1").arg(rating - 15);
+					skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
+						.arg(gdr->get_skill_level_name(rating))
+						.arg(gdr->get_skill_name(m_skill_id))
+						.arg(adjusted_rating)
+						.arg(d->get_skill(m_skill_id).exp_summary());
+				} else {
+					// either the skill isn't a valid id, or they have 0 experience in it
+					skill_str = "0 experience";
+				}
+				return QString("<h3>%1</h3>%2<h4>%3</h4>").arg(m_title).arg(skill_str).arg(d->nice_name());
+			}
+		default:
+			return ViewColumn::cell_data(d, role);
 	}
-	item->setToolTip(QString("<h3>%1</h3>%2<h4>%3</h4>").arg(m_title).arg(skill_str).arg(d->nice_name()));
-	return item;
 }
 
-QStandardItem *LaborColumn::build_aggregate(const QString &group_name, const QVector<Dwarf*> &) {
-	QStandardItem *item = new QStandardItem;
-	item->setStatusTip(m_title + " :: " + group_name);
-	QColor bg;
-	if (m_override_set_colors) {
-		bg = m_bg_color;
-	} else {
-		bg = set()->bg_color();
+QVariant LaborColumn::aggregate_data(const QString &group_name, const QVector<Dwarf*> &dwarves, int role) {
+	switch (role) {
+		case Qt::StatusTipRole:
+			return m_title + " :: " + group_name;
+		case DwarfModel::DR_COL_TYPE:
+			return CT_LABOR;
+		case DwarfModel::DR_IS_AGGREGATE:
+			return true;
+		case DwarfModel::DR_LABOR_ID:
+			return m_labor_id;
+		case DwarfModel::DR_GROUP_NAME:
+			return group_name;
+		case DwarfModel::DR_RATING:
+			return 0;
+		case DwarfModel::DR_SET_NAME:
+			return m_set->name();
+		default:
+			return ViewColumn::aggregate_data(group_name, dwarves, role);
 	}
-	item->setData(CT_LABOR, DwarfModel::DR_COL_TYPE);
-	item->setData(bg, Qt::BackgroundColorRole);
-	item->setData(bg, DwarfModel::DR_DEFAULT_BG_COLOR);
-	item->setData(true, DwarfModel::DR_IS_AGGREGATE);
-	item->setData(m_labor_id, DwarfModel::DR_LABOR_ID);
-	item->setData(group_name, DwarfModel::DR_GROUP_NAME);
-	item->setData(0, DwarfModel::DR_RATING);
-	item->setData(m_set->name(), DwarfModel::DR_SET_NAME);
-	return item;
 }
 
 void LaborColumn::write_to_ini(QSettings &s) {
 	ViewColumn::write_to_ini(s); 
 	s.setValue("skill_id", m_skill_id); 
 	s.setValue("labor_id", m_labor_id);
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -47,60 +47,57 @@ MilitaryPreferenceColumn::MilitaryPreferenceColumn(const MilitaryPreferenceColum
     , m_skill_id(to_copy.m_skill_id)
 {}
 
-QStandardItem *MilitaryPreferenceColumn::build_cell(Dwarf *d) {
-	GameDataReader *gdr = GameDataReader::ptr();
-	QStandardItem *item = init_cell(d);
+QVariant MilitaryPreferenceColumn::cell_data(Dwarf *d, int role) {
+	switch (role) {
+		case DwarfModel::DR_SORT_VALUE:
+			// push assigned labors above no exp in sort order
+			return d->get_rating_by_skill(m_skill_id) * (d->pref_value(m_labor_id) + 1);
+		case DwarfModel::DR_RATING:
+			return d->get_rating_by_skill(m_skill_id);
+		case DwarfModel::DR_LABOR_ID:
+			return m_labor_id;
+		case DwarfModel::DR_SET_NAME:
+			return m_set->name();
+		case Qt::ToolTipRole:
+			{
+				GameDataReader *gdr = GameDataReader::ptr();
+				short rating = d->get_rating_by_skill(m_skill_id);
+				short val = d->pref_value(m_labor_id);
+				QString val_name = gdr->get_military_preference(m_labor_id)->value_name(val);
 
-	item->setData(CT_MILITARY_PREFERENCE, DwarfModel::DR_COL_TYPE);
-	short rating = d->get_rating_by_skill(m_skill_id);
-    short val = d->pref_value(m_labor_id);
-    QString val_name = gdr->get_military_preference(m_labor_id)->value_name(val);
-
-    item->setData(rating * (val + 1), DwarfModel::DR_SORT_VALUE); // push assigned labors above no exp in sort order
-	item->setData(rating, DwarfModel::DR_RATING);
-	item->setData(m_labor_id, DwarfModel::DR_LABOR_ID);
-	item->setData(m_set->name(), DwarfModel::DR_SET_NAME);
-	
-	QString skill_str;
-	if (m_skill_id != -1 && rating > -1) {
-		QString adjusted_rating = QString::number(rating);
-		if (rating > 15)
-			adjusted_rating = QString("15 +%1").arg(rating - 15);
-        skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
-			.arg(gdr->get_skill_level_name(rating))
-			.arg(gdr->get_skill_name(m_skill_id))
-			.arg(adjusted_rating)
-			.arg(d->get_skill(m_skill_id).exp_summary());
-	} else {
-		// either the skill isn't a valid id, or they have 0 experience in it
-		skill_str = "0 experience";
+				QString skill_str;
+				if (m_skill_id != -1 && rating > -1) {
+					QString adjusted_rating = QString::number(rating);
+					if (rating > 15)
+						adjusted_rating = QString("15 +%1").arg(rating - 15);
+					skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
+						.arg(gdr->get_skill_level_name(rating))
+						.arg(gdr->get_skill_name(m_skill_id))
+						.arg(adjusted_rating)
+						.arg(d->get_skill(m_skill_id).exp_summary());
+				} else {
+					// either the skill isn't a valid id, or they have 0 experience in it
+					skill_str = "0 experience";
+				}
+				return QString("<h3>%1</h3><b>USING: %2</b><br/>%3<h4>%4</h4>")
+					.arg(m_title)
+					.arg(val_name)
+					.arg(skill_str)
+					.arg(d->nice_name());
+			}
+		default:
+			return ViewColumn::cell_data(d, role);
 	}
-    item->setToolTip(QString("<h3>%1</h3><b>USING: %2</b><br/>%3<h4>%4</h4>")
-        .arg(m_title)
-        .arg(val_name)
-        .arg(skill_str)
-        .arg(d->nice_name())
-    );
-	return item;
 }
 
-QStandardItem *MilitaryPreferenceColumn::build_aggregate(const QString &group_name, const QVector<Dwarf*> &) {
-	Q_UNUSED(group_name);
-	QStandardItem *item = new QStandardItem;
-	item->setData(CT_MILITARY_PREFERENCE, DwarfModel::DR_COL_TYPE);
-	
-	QColor bg;
-	if (m_override_set_colors) {
-		bg = m_bg_color;
-	} else {
-		bg = set()->bg_color();
-	}
-	item->setData(bg, Qt::BackgroundColorRole);
-	return item;
+QVariant MilitaryPreferenceColumn::aggregate_data(const QString &group_name, const QVector<Dwarf*> &dwarves, int role) {
+	if (role == DwarfModel::DR_COL_TYPE)
+		return CT_MILITARY_PREFERENCE;
+	return ViewColumn::aggregate_data(group_name, dwarves, role);
 }
 
 void MilitaryPreferenceColumn::write_to_ini(QSettings &s) {
 	ViewColumn::write_to_ini(s); 
 	s.setValue("skill_id", m_skill_id); 
 	s.setValue("labor_id", m_labor_id);
-}
\ No newline at end of file
+}
\ No newline at end of file
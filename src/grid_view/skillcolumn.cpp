@@ -43,41 +43,32 @@ SkillColumn::SkillColumn(const SkillColumn &to_copy)
     , m_skill_id(to_copy.m_skill_id)
 {}
 
-QStandardItem *SkillColumn::build_cell(Dwarf *d) {
-	GameDataReader *gdr = GameDataReader::ptr();
-	QStandardItem *item = init_cell(d);
-
-	item->setData(CT_SKILL, DwarfModel::DR_COL_TYPE);
-	short rating = d->get_rating_by_skill(m_skill_id);
-	item->setData(rating, DwarfModel::DR_RATING);
-	item->setData(rating, DwarfModel::DR_SORT_VALUE);
-
-	QString skill_str;
-	if (m_skill_id != -1 && rating > -1) {
-		QString adjusted_rating = QString::number(rating);
-		if (rating > 15)
-			adjusted_rating = QString("15 +%1").arg(rating - 15);
-		skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
-			.arg(gdr->get_skill_level_name(rating))
-			.arg(gdr->get_skill_name(m_skill_id))
-			.arg(adjusted_rating)
-			.arg(d->get_skill(m_skill_id).exp_summary());
-	} else {
-		// either the skill isn't a valid id, or they have 0 experience in it
-		skill_str = "0 experience";
+QVariant SkillColumn::cell_data(Dwarf *d, int role) {
+	switch (role) {
+		case DwarfModel::DR_RATING:
+		case DwarfModel::DR_SORT_VALUE:
+			return d->get_rating_by_skill(m_skill_id);
+		case Qt::ToolTipRole:
+			{
+				GameDataReader *gdr = GameDataReader::ptr();
+				short rating = d->get_rating_by_skill(m_skill_id);
+				QString skill_str;
+				if (m_skill_id != -1 && rating > -1) {
+					QString adjusted_rating = QString::number(rating);
+					if (rating > 15)
+						adjusted_rating = QString("15 +%1").arg(rating - 15);
+					skill_str = tr("%1 %2<br/>[RAW LEVEL: <b><font color=blue>%3</font></b>]<br/><b>Experience:</b><br/>%4")
+						.arg(gdr->get_skill_level_name(rating))
+						.arg(gdr->get_skill_name(m_skill_id))
+						.arg(adjusted_rating)
+						.arg(d->get_skill(m_skill_id).exp_summary());
+				} else {
+					// either the skill isn't a valid id, or they have 0 experience in it
+					skill_str = "0 experience";
+				}
+				return QString("<h3>%1</h3>%2<h4>%3</h4>").arg(m_title).arg(skill_str).arg(d->nice_name());
+			}
+		default:
+			return ViewColumn::cell_data(d, role);
 	}
-	item->setToolTip(QString("<h3>%1</h3>%2<h4>%3</h4>").arg(m_title).arg(skill_str).arg(d->nice_name()));
-	return item;
-}
-
-QStandardItem *SkillColumn::build_aggregate(const QString &, const QVector<Dwarf*> &) {
-	QStandardItem *item = new QStandardItem;
-	QColor bg;
-	if (m_override_set_colors)
-		bg = m_bg_color;
-	else
-		bg = m_set->bg_color();
-	item->setData(bg, Qt::BackgroundColorRole);
-	item->setData(bg, DwarfModel::DR_DEFAULT_BG_COLOR);
-	return item;
-}
\ No newline at end of file
+}
\ No newline at end of file
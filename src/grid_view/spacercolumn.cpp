@@ -44,27 +44,8 @@ SpacerColumn::SpacerColumn(const SpacerColumn &to_copy)
     , m_width(to_copy.m_width)
 {}
 
-QStandardItem *SpacerColumn::build_cell(Dwarf *d) {
-	QStandardItem *item = init_cell(d);
-	return item;
-}
-
-QStandardItem *SpacerColumn::build_aggregate(const QString &, const QVector<Dwarf*> &) {
-	QStandardItem *item = new QStandardItem;
-	QColor bg;
-	if (m_override_set_colors) {
-		bg = m_bg_color;
-	} else {
-		bg = set()->bg_color();
-	}
-	item->setData(bg, Qt::BackgroundColorRole);
-	item->setData(bg, DwarfModel::DR_DEFAULT_BG_COLOR);
-	item->setData(false, DwarfModel::DR_IS_AGGREGATE);
-	return item;
-}
-
 void SpacerColumn::write_to_ini(QSettings &s) {
 	ViewColumn::write_to_ini(s);
 	if (m_width)
 		s.setValue("width", m_width);
-}
\ No newline at end of file
+}
\ No newline at end of file
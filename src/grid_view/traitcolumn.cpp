@@ -51,37 +51,29 @@ TraitColumn::TraitColumn(const TraitColumn &to_copy)
     , m_trait(to_copy.m_trait)
 {}
 
-QStandardItem *TraitColumn::build_cell(Dwarf *d) {
-    QStandardItem *item = init_cell(d);
-    item->setData(CT_TRAIT, DwarfModel::DR_COL_TYPE);
-
+QVariant TraitColumn::cell_data(Dwarf *d, int role) {
     short score = d->trait(m_trait_id);
-    QString msg = "???";
-    if (m_trait)
-        msg = m_trait->level_message(score);
-
-    if (score == -1) { // not an active trait...
-        item->setText("");
-        item->setData(50, DwarfModel::DR_SORT_VALUE);
-        msg = tr("Not an active trait for this dwarf");
-    } else {
-        item->setText(QString::number(score));
-        item->setData(score, DwarfModel::DR_SORT_VALUE);
+    switch (role) {
+        case Qt::DisplayRole:
+            if (score == -1) // not an active trait...
+                return QString();
+            return QString::number(score);
+        case DwarfModel::DR_SORT_VALUE:
+            return score == -1 ? 50 : score;
+        case Qt::ToolTipRole:
+            {
+                QString msg = "???";
+                if (score == -1)
+                    msg = tr("Not an active trait for this dwarf");
+                else if (m_trait)
+                    msg = m_trait->level_message(score);
+                return QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
+                    .arg(m_title)
+                    .arg(msg)
+                    .arg(score)
+                    .arg(d->nice_name());
+            }
+        default:
+            return ViewColumn::cell_data(d, role);
     }
-    
-    QString tooltip = QString("<h3>%1</h3>%2 (%3)<h4>%4</h4>")
-        .arg(m_title)
-        .arg(msg)
-        .arg(score)
-        .arg(d->nice_name());
-    item->setToolTip(tooltip);
-    return item;
-}
-
-QStandardItem *TraitColumn::build_aggregate(const QString &group_name, const QVector<Dwarf*> &dwarves) {
-    Q_UNUSED(group_name);
-    Q_UNUSED(dwarves);
-    QStandardItem *item = new QStandardItem;
-    item->setData(m_bg_color, DwarfModel::DR_DEFAULT_BG_COLOR);
-    return item;
 }
@@ -70,21 +70,39 @@ ViewColumn::ViewColumn(const ViewColumn &to_copy)
         m_bg_color = m_set->bg_color();
 }
 
-QStandardItem *ViewColumn::init_cell(Dwarf *d) {
-    QStandardItem *item = new QStandardItem;
-    item->setStatusTip(QString("%1 :: %2").arg(m_title).arg(d->nice_name()));
-    QColor bg;
-    if (m_override_set_colors) {
-        bg = m_bg_color;
-    } else {
-        bg = set()->bg_color();
+QColor ViewColumn::cell_bg() {
+    if (m_override_set_colors || !m_set)
+        return m_bg_color;
+    return m_set->bg_color();
+}
+
+QVariant ViewColumn::cell_data(Dwarf *d, int role) {
+    switch (role) {
+        case Qt::StatusTipRole:
+            return QString("%1 :: %2").arg(m_title).arg(d->nice_name());
+        case Qt::BackgroundColorRole:
+        case DwarfModel::DR_DEFAULT_BG_COLOR:
+            return cell_bg();
+        case DwarfModel::DR_IS_AGGREGATE:
+            return false;
+        case DwarfModel::DR_ID:
+            return d->id();
+        case DwarfModel::DR_COL_TYPE:
+            return m_type;
+        default:
+            return QVariant();
+    }
+}
+
+QVariant ViewColumn::aggregate_data(const QString &, const QVector<Dwarf*> &,
+                                    int role) {
+    switch (role) {
+        case Qt::BackgroundColorRole:
+        case DwarfModel::DR_DEFAULT_BG_COLOR:
+            return cell_bg();
+        default:
+            return QVariant();
     }
-    item->setData(bg, Qt::BackgroundColorRole);
-    item->setData(bg, DwarfModel::DR_DEFAULT_BG_COLOR);
-    item->setData(false, DwarfModel::DR_IS_AGGREGATE);
-    item->setData(d->id(), DwarfModel::DR_ID);
-    m_cells[d] = item;
-    return item;
 }
 
 void ViewColumn::write_to_ini(QSettings &s) {
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "traitcolumn.h"
 #include "attributecolumn.h"
 #include "militarypreferencecolumn.h"
+#include "expressioncolumn.h"
 #include "gamedatareader.h"
 #include "truncatingfilelogger.h"
 #include "labor.h"
@@ -112,7 +113,8 @@ void ViewColumnSet::toggle_for_dwarf_group() {
 
     int total_enabled = 0;
     int total_labors = 0;
-    foreach(Dwarf *d, dm->get_dwarf_groups()->value(group_name)) {
+    QVector<Dwarf*> members = dm->group_members(group_name);
+    foreach(Dwarf *d, members) {
         foreach(ViewColumn *vc, m_columns) {
             if (vc->type() == CT_LABOR) {
                 total_labors++;
@@ -123,7 +125,7 @@ void ViewColumnSet::toggle_for_dwarf_group() {
         }
     }
     bool turn_on = total_enabled < total_labors;
-    foreach(Dwarf *d, dm->get_dwarf_groups()->value(group_name)) {
+    foreach(Dwarf *d, members) {
         foreach(ViewColumn *vc, m_columns) {
             if (vc->type() == CT_LABOR) {
                 LaborColumn *lc = static_cast<LaborColumn*>(vc);
@@ -235,6 +237,9 @@ ViewColumnSet *ViewColumnSet::read_from_ini(QSettings &s, QObject *parent) {
             case CT_MILITARY_PREFERENCE:
                 new MilitaryPreferenceColumn(s, ret_val, parent);
                 break;
+            case CT_EXPRESSION:
+                new ExpressionColumn(s, ret_val, parent);
+                break;
             case CT_DEFAULT:
             default:
                 LOGW << "unidentified column type in set" << ret_val->name() << "!";
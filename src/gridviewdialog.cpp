@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "traitcolumn.h"
 #include "attributecolumn.h"
 #include "militarypreferencecolumn.h"
+#include "expressioncolumn.h"
 
 #include "defines.h"
 #include "statetableview.h"
@@ -383,6 +384,10 @@ void GridViewDialog::draw_column_context_menu(const QPoint &p) {
 
         a = m->addAction(tr("Add Idle/Current Job"), this, SLOT(add_idle_column()));
         a->setToolTip(tr("Adds a single column that shows a the current idle state for a dwarf."));
+
+        a = m->addAction(tr("Add Expression..."), this, SLOT(add_expression_column()));
+        a->setToolTip(tr("Adds a read-only column showing the value of an expression such as "
+            "skill(0) + skill(1), see the script dialog for the names you can use."));
     }
     m->exec(ui->list_columns->viewport()->mapToGlobal(p));
 }
@@ -460,6 +465,23 @@ void GridViewDialog::add_military_preferences_column() {
     draw_columns_for_set(m_active_set);
 }
 
+void GridViewDialog::add_expression_column() {
+    if (!m_active_set)
+        return;
+    bool ok;
+    QString text = QInputDialog::getText(this, tr("Add Expression Column"),
+        tr("Expression:"), QLineEdit::Normal, QString(), &ok);
+    if (!ok || text.trimmed().isEmpty())
+        return;
+    DwarfExpression e(text);
+    if (!e.is_valid()) {
+        QMessageBox::warning(this, tr("Invalid Expression"), e.error());
+        return;
+    }
+    new ExpressionColumn(text, text, m_active_set, m_active_set);
+    draw_columns_for_set(m_active_set);
+}
+
 void GridViewDialog::accept() {
     if (ui->le_name->text().isEmpty()) {
         QMessageBox::warning(this, tr("Empty Name"), tr("Cannot save a view with no name!"));
@@ -126,24 +126,24 @@ MainWindow::MainWindow(QWidget *parent)
     statusBar()->addPermanentWidget(m_lbl_status, 0);
     set_interface_enabled(false);
 
-    ui->cb_group_by->setItemData(0, DwarfModel::GB_NOTHING);
-    ui->cb_group_by->addItem(tr("Profession"), DwarfModel::GB_PROFESSION);
-    ui->cb_group_by->addItem(tr("Legendary Status"), DwarfModel::GB_LEGENDARY);
-    ui->cb_group_by->addItem(tr("Sex"), DwarfModel::GB_SEX);
-    ui->cb_group_by->addItem(tr("Happiness"), DwarfModel::GB_HAPPINESS);
-    ui->cb_group_by->addItem(tr("Migration Wave"),
-                             DwarfModel::GB_MIGRATION_WAVE);
-    ui->cb_group_by->addItem(tr("Current Job"), DwarfModel::GB_CURRENT_JOB);
-    ui->cb_group_by->addItem(tr("Military Status"),
-                             DwarfModel::GB_MILITARY_STATUS);
-    ui->cb_group_by->addItem(tr("Highest Skill"), DwarfModel::GB_HIGHEST_SKILL);
-    ui->cb_group_by->addItem(tr("Total Skill Levels"),
-                             DwarfModel::GB_TOTAL_SKILL_LEVELS);
-    ui->cb_group_by->addItem(tr("Total Assigned Labors"),
-                             DwarfModel::GB_ASSIGNED_LABORS);
-    ui->cb_group_by->addItem(tr("Has Nickname"),
-                             DwarfModel::GB_HAS_NICKNAME);
-    ui->cb_group_by->addItem(tr("Squad"), DwarfModel::GB_SQUAD);
+    // the second and third combos nest groups inside the first one's
+    foreach(QComboBox *cb, group_by_combos()) {
+        cb->setItemData(0, DwarfModel::GB_NOTHING);
+        cb->addItem(tr("Profession"), DwarfModel::GB_PROFESSION);
+        cb->addItem(tr("Legendary Status"), DwarfModel::GB_LEGENDARY);
+        cb->addItem(tr("Sex"), DwarfModel::GB_SEX);
+        cb->addItem(tr("Happiness"), DwarfModel::GB_HAPPINESS);
+        cb->addItem(tr("Migration Wave"), DwarfModel::GB_MIGRATION_WAVE);
+        cb->addItem(tr("Current Job"), DwarfModel::GB_CURRENT_JOB);
+        cb->addItem(tr("Military Status"), DwarfModel::GB_MILITARY_STATUS);
+        cb->addItem(tr("Highest Skill"), DwarfModel::GB_HIGHEST_SKILL);
+        cb->addItem(tr("Total Skill Levels"),
+                    DwarfModel::GB_TOTAL_SKILL_LEVELS);
+        cb->addItem(tr("Total Assigned Labors"),
+                    DwarfModel::GB_ASSIGNED_LABORS);
+        cb->addItem(tr("Has Nickname"), DwarfModel::GB_HAS_NICKNAME);
+        cb->addItem(tr("Squad"), DwarfModel::GB_SQUAD);
+    }
 
     read_settings();
     draw_professions();
@@ -177,9 +177,10 @@ void MainWindow::read_settings() {
 
     m_settings->beginGroup("gui_options");
     { // GUI OPTIONS
-        int group_by = m_settings->value("group_by", 0).toInt();
-        ui->cb_group_by->setCurrentIndex(group_by);
-        m_model->set_group_by(group_by);
+        ui->cb_group_by->setCurrentIndex(m_settings->value("group_by", 0).toInt());
+        ui->cb_group_by_2->setCurrentIndex(m_settings->value("group_by_2", 0).toInt());
+        ui->cb_group_by_3->setCurrentIndex(m_settings->value("group_by_3", 0).toInt());
+        m_model->set_group_levels(group_levels());
     }
     m_settings->endGroup();
     m_reading_settings = false;
@@ -195,7 +196,9 @@ void MainWindow::write_settings() {
         m_settings->setValue("state", QVariant(state));
         m_settings->endGroup();
         m_settings->beginGroup("gui_options");
-        m_settings->setValue("group_by", m_model->current_grouping());
+        m_settings->setValue("group_by", ui->cb_group_by->currentIndex());
+        m_settings->setValue("group_by_2", ui->cb_group_by_2->currentIndex());
+        m_settings->setValue("group_by_3", ui->cb_group_by_3->currentIndex());
         m_settings->endGroup();
 
         LOGD << "finished writing settings";
@@ -323,7 +326,9 @@ void MainWindow::set_interface_enabled(bool enabled) {
     //ui->act_scan_memory->setEnabled(enabled);
     ui->act_expand_all->setEnabled(enabled);
     ui->act_collapse_all->setEnabled(enabled);
-    ui->cb_group_by->setEnabled(enabled);
+    foreach(QComboBox *cb, group_by_combos()) {
+        cb->setEnabled(enabled);
+    }
     ui->act_import_existing_professions->setEnabled(enabled);
     ui->act_print->setEnabled(enabled);
 }
@@ -473,9 +478,24 @@ void MainWindow::scan_memory() {
     }
 }
 
-void MainWindow::set_group_by(int group_by) {
+void MainWindow::set_group_by(int) {
     write_settings();
-    m_view_manager->set_group_by(group_by);
+    m_view_manager->set_group_levels(group_levels());
+}
+
+QList<QComboBox*> MainWindow::group_by_combos() const {
+    return QList<QComboBox*>() << ui->cb_group_by << ui->cb_group_by_2
+                               << ui->cb_group_by_3;
+}
+
+QList<int> MainWindow::group_levels() const {
+    QList<int> levels;
+    foreach(QComboBox *cb, group_by_combos()) {
+        int group_by = cb->itemData(cb->currentIndex()).toInt();
+        if (group_by != DwarfModel::GB_NOTHING && !levels.contains(group_by))
+            levels << group_by;
+    }
+    return levels;
 }
 
 void MainWindow::show_about() {
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "statetableview.h"
 #include "truncatingfilelogger.h"
 #include "dwarftherapist.h"
+#include "gamedatareader.h"
 
 #include "columntypes.h"
 #include "gridview.h"
@@ -44,11 +45,26 @@ THE SOFTWARE.
 
 
 DwarfModel::DwarfModel(QObject *parent)
-    : QStandardItemModel(parent)
+    : QAbstractItemModel(parent)
     , m_df(0)
-    , m_group_by(GB_NOTHING)
     , m_selected_col(-1)
-{}
+    , m_grouped(false)
+    , m_batch_depth(0)
+    , m_pending_total(0)
+    , m_icn_male(":img/male.png")
+    , m_icn_female(":img/female.png")
+{
+    // rich tooltips are formatted only when hovered, and the same one is
+    // asked for again and again while the mouse rests on a cell
+    m_tooltips.setMaxCost(TOOLTIP_CACHE_SIZE);
+    connect(this, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+            SLOT(clear_tooltips()));
+    connect(this, SIGNAL(rowsInserted(const QModelIndex&, int, int)),
+            SLOT(clear_tooltips()));
+    connect(this, SIGNAL(rowsRemoved(const QModelIndex&, int, int)),
+            SLOT(clear_tooltips()));
+    connect(this, SIGNAL(modelReset()), SLOT(clear_tooltips()));
+}
 
 DwarfModel::~DwarfModel() {
     clear_all();
@@ -56,12 +72,16 @@ DwarfModel::~DwarfModel() {
 
 void DwarfModel::clear_all() {
     clear_pending();
+    beginResetModel();
+    qDeleteAll(m_groups);
+    m_groups.clear();
+    m_columns.clear();
+    endResetModel();
     foreach(Dwarf *d, m_dwarves) {
         delete d;
     }
     m_dwarves.clear();
-    m_grouped_dwarves.clear();
-    clear();
+    m_group_keys.clear();
 }
 
 void DwarfModel::section_right_clicked(int col) {
@@ -74,13 +94,13 @@ void DwarfModel::section_right_clicked(int col) {
 }
 
 void DwarfModel::load_dwarves() {
-    // clear id->dwarf map
-    foreach(Dwarf *d, m_dwarves) {
-        delete d;
-    }
+    // the old dwarves stay alive until the rows showing them have been
+    // matched up with their replacements
+    QMap<int, Dwarf*> old_dwarves = m_dwarves;
     m_dwarves.clear();
-    if (rowCount())
-        removeRows(0, rowCount());
+    m_group_keys.clear();
+    m_pending_counts.clear(); // a fresh read has nothing pending
+    m_pending_total = 0;
 
     m_df->attach();
 
@@ -88,8 +108,16 @@ void DwarfModel::load_dwarves() {
         m_dwarves[d->id()] = d;
     }
 
+    // index dwarves by squad ref id once, rather than scanning every dwarf
+    // for every squad member
+    QHash<int, Dwarf*> dwarves_by_ref_id;
+    foreach(Dwarf *d, m_dwarves) {
+        if (d->get_squad_ref_id() != -1)
+            dwarves_by_ref_id.insert(d->get_squad_ref_id(), d);
+    }
+
     m_squads.clear();
-    foreach(Squad * s, m_df->load_squads()) {
+    foreach(Squad * s, m_df->load_squads(dwarves_by_ref_id)) {
         m_squads[s->id()] = s;
     }
 
@@ -110,6 +138,13 @@ void DwarfModel::load_dwarves() {
         dwarves[i]->set_migration_wave(wave);
     }
 
+    if (!m_gridviews.isEmpty() && !m_groups.isEmpty())
+        build_rows(); // swap the new dwarves into the existing rows
+    else
+        reset_rows();
+    foreach(Dwarf *d, old_dwarves) {
+        delete d;
+    }
 
 #if 0
     // NOTE: This way no longer works due to the fact that historical
@@ -135,257 +170,826 @@ void DwarfModel::load_dwarves() {
 #endif
 }
 
+void DwarfModel::reset_rows() {
+    beginResetModel();
+    qDeleteAll(m_groups);
+    m_groups.clear();
+    endResetModel();
+}
+
+void DwarfModel::DwarfGroup::count_labors(const LaborTally &t, int sign) {
+    for (int labor_id = 0; labor_id < LaborSet::MAX_LABORS; ++labor_id) {
+        if (t.enabled.test(labor_id))
+            enabled_counts[labor_id] += sign;
+        if (t.dirty.test(labor_id))
+            dirty_counts[labor_id] += sign;
+        if (t.pref_dirty.test(labor_id))
+            pref_dirty_counts[labor_id] += sign;
+    }
+}
+
+DwarfModel::LaborTally DwarfModel::tally_of(const Dwarf *d) {
+    LaborTally t;
+    t.enabled = d->enabled_labor_set();
+    t.dirty = d->dirty_labor_set();
+    t.pref_dirty = d->dirty_pref_set();
+    return t;
+}
+
 void DwarfModel::build_rows() {
-    // don't need to go delete the dwarf pointers in here, since the earlier foreach should have
-    // deleted them
-    m_grouped_dwarves.clear();
-    clear();
+    clear_tooltips(); // pending changes may have been dropped without a signal
+    // the groups are counted afresh (and kept groups take the fresh counts)
+    m_tallies.clear();
+    foreach(Dwarf *d, m_dwarves) {
+        m_tallies.insert(d->id(), tally_of(d));
+    }
+    QVector<QPointer<ViewColumn> > columns;
+    m_view_columns.clear();
+    foreach(GridView *v, m_gridviews) {
+        if (!v) // deleted since it was shown
+            continue;
+        int first = columns.size() + 1; // the name column comes first
+        foreach(ViewColumnSet *set, v->sets()) {
+            foreach(ViewColumn *col, set->columns()) {
+                columns << col;
+            }
+        }
+        m_view_columns.insert(v, qMakePair(first, columns.size() + 1 - first));
+    }
+    // rows can only be patched in place while they keep their shape (and
+    // group keys keep their meaning)
+    bool patch = !m_groups.isEmpty() && columns == m_columns &&
+                 m_rows_levels == m_group_levels;
+    if (!patch) {
+        beginResetModel();
+        qDeleteAll(m_groups);
+        m_groups.clear();
+        m_columns = columns;
+        m_rows_levels = m_group_levels;
+        m_grouped = !m_rows_levels.isEmpty();
+    }
+    QList<DwarfGroup*> groups;
+    build_groups(groups, 0, 0, m_dwarves.values().toVector());
+
+    if (patch) {
+        merge_groups(0, QModelIndex(), groups);
+        return; // the header hasn't changed
+    }
+
+    m_groups = groups;
+    endResetModel();
+    for (int i = 0; i < m_groups.size(); ++i)
+        index_members(m_groups.at(i), index(i, 0));
 
     /*
     TODO: Move this to the RotatedHeader class
     */
-    int start_col = 1;
-    setHorizontalHeaderItem(0, new QStandardItem);
     emit clear_spacers();
     QSettings *s = DT->user_settings();
     int width = s->value("options/grid/cell_size", DEFAULT_CELL_SIZE).toInt();
-    foreach(ViewColumnSet *set, m_gridview->sets()) {
-        /*QStandardItem *set_header = new QStandardItem(set->name());
-        set_header->setData(set->bg_color(), Qt::BackgroundColorRole);
-        set_header->setData(true);
-        setHorizontalHeaderItem(start_col++, set_header);
-        emit set_index_as_spacer(start_col - 1);
-        emit preferred_header_size(start_col - 1, width);*/
-        foreach(ViewColumn *col, set->columns()) {
-            QStandardItem *header = new QStandardItem(col->title());
-            header->setData(col->bg_color(), Qt::BackgroundColorRole);
-            header->setData(set->name(), Qt::UserRole);
-            setHorizontalHeaderItem(start_col++, header);
-            switch (col->type()) {
-                case CT_SPACER:
-                    {
-                        SpacerColumn *c = static_cast<SpacerColumn*>(col);
-                        emit set_index_as_spacer(start_col - 1);
-                        emit preferred_header_size(start_col - 1, c->width());
-                    }
-                    break;
-                default:
-                    emit preferred_header_size(start_col - 1, width);
+    for (int i = 0; i < m_columns.size(); ++i) {
+        int section = i + 1; // the name column comes first
+        if (m_columns.at(i)->type() == CT_SPACER) {
+            SpacerColumn *c = static_cast<SpacerColumn*>(m_columns.at(i).data());
+            emit set_index_as_spacer(section);
+            emit preferred_header_size(section, c->width());
+        } else {
+            emit preferred_header_size(section, width);
+        }
+    }
+}
+
+void DwarfModel::build_groups(QList<DwarfGroup*> &out, DwarfGroup *parent, int level,
+                              const QVector<Dwarf*> &dwarves) {
+    QVector<int> keys;
+    QVector<QVector<Dwarf*> > buckets;
+    partition(dwarves, mode_at(level), keys, buckets);
+    for (int i = 0; i < keys.size(); ++i) {
+        DwarfGroup *g = new DwarfGroup;
+        g->key = keys.at(i);
+        g->level = level;
+        g->parent = parent;
+        g->members = buckets.at(i);
+        if (m_grouped) {
+            foreach(Dwarf *d, g->members) {
+                g->count_labors(m_tallies.value(d->id()), 1);
             }
         }
+        if (!is_leaf(g))
+            build_groups(g->children, g, level + 1, g->members);
+        out << g;
+    }
+}
+
+void DwarfModel::index_members(DwarfGroup *g, const QModelIndex &g_idx) {
+    if (!m_grouped) {
+        g->members.at(0)->m_name_idx = g_idx; // the row is the dwarf
+    } else if (is_leaf(g)) {
+        for (int row = 0; row < g->members.size(); ++row)
+            g->members.at(row)->m_name_idx = index(row, 0, g_idx);
+    } else {
+        for (int row = 0; row < g->children.size(); ++row)
+            index_members(g->children.at(row), index(row, 0, g_idx));
     }
+}
 
-    // populate dwarf maps
-    foreach(Dwarf *d, m_dwarves) {
-        switch (m_group_by) {
-            default:
-            case GB_NOTHING:
-                m_grouped_dwarves[QString::number(d->id())].append(d);
-                break;
-            case GB_PROFESSION:
-                m_grouped_dwarves[d->profession()].append(d);
-                break;
-            case GB_LEGENDARY:
-                {
-                    int legendary_skills = 0;
-                    foreach(Skill s, *d->get_skills()) {
-                        if (s.rating() >= 15)
-                            legendary_skills++;
-                    }
-                    if (legendary_skills)
-                        m_grouped_dwarves[tr("Legends")].append(d);
-                    else
-                        m_grouped_dwarves[tr("Losers")].append(d);
-                    break;
-                }
-            case GB_SEX:
-                if (d->is_male())
-                    m_grouped_dwarves[tr("Males")].append(d);
-                else
-                    m_grouped_dwarves[tr("Females")].append(d);
-                break;
-            case GB_HAPPINESS:
-                m_grouped_dwarves[d->happiness_name(d->get_happiness())].append(d);
-                break;
-            case GB_MIGRATION_WAVE:
-                m_grouped_dwarves[QString("Wave %1").arg(d->migration_wave())].append(d);
-                break;
-            case GB_CURRENT_JOB:
-                m_grouped_dwarves[d->current_job()].append(d);
-                break;
-            case GB_MILITARY_STATUS:
-                {
-                    // groups
-                    if (d->profession() == "Baby" ||
-                        d->profession() == "Child") {
-                        m_grouped_dwarves[tr("Juveniles")].append(d);
-                    } else if (d->active_military() && !d->can_set_labors()) { // epic military
-                        m_grouped_dwarves[tr("Champions")].append(d);
-                    } else if (!d->can_set_labors()) {
-                        m_grouped_dwarves[tr("Nobles")].append(d);
-                    } else if (d->active_military()) {
-                        m_grouped_dwarves[tr("Active Military")].append(d);
-                    } else {
-                        m_grouped_dwarves[tr("Can Activate")].append(d);
-                    }
-                    /*
-                    4a) Heroes and Champions (who cannot deactivate)
-                    4b) Non-Heroic Soldiers and Guards (who can deactivate)
-                    4c) Civilians (who can activate)
-                    4d) Juveniles (who may one day activate)
-                    4e) Immigrant Nobles (who are forever off-limits)
-                    */
-                }
-                break;
-            case GB_HIGHEST_SKILL:
-                {
-                    Skill highest = d->highest_skill();
-                    GameDataReader *gdr = GameDataReader::ptr();
-                    QString level = gdr->get_skill_level_name(highest.rating());
-                    m_grouped_dwarves[level].append(d);
-                }
-                break;
-            case GB_TOTAL_SKILL_LEVELS:
-                m_grouped_dwarves[tr("Levels: %1").arg(d->total_skill_levels())]
-                    .append(d);
-                break;
-            case GB_ASSIGNED_LABORS:
-                m_grouped_dwarves[tr("%1 Assigned Labors")
-                                  .arg(d->total_assigned_labors())].append(d);
-                break;
-            case GB_HAS_NICKNAME:
-                {
-                    if (d->nickname().isEmpty()) {
-                        m_grouped_dwarves[tr("No Nickname")].append(d);
-                    } else {
-                        m_grouped_dwarves[tr("Has Nickname")].append(d);
-                    }
-                }
-                break;
-            case GB_SQUAD:
-                {
-                    if(d->squad_name().isEmpty()) {
-                        m_grouped_dwarves[tr("No Squad")].append(d);
-                    } else {
-                        m_grouped_dwarves[d->squad_name()].append(d);
-                    }
+void DwarfModel::merge_groups(DwarfGroup *parent, const QModelIndex &parent_idx,
+                              QList<DwarfGroup*> fresh) {
+    // both the current rows and the fresh groups are sorted by key, so one
+    // merging pass finds every group that appeared, vanished or changed
+    QList<DwarfGroup*> &rows = parent ? parent->children : m_groups;
+    int row = 0;
+    int k = 0;
+    while (row < rows.size() || k < fresh.size()) {
+        if (k >= fresh.size() ||
+            (row < rows.size() && rows.at(row)->key < fresh.at(k)->key)) {
+            beginRemoveRows(parent_idx, row, row);
+            delete rows.takeAt(row);
+            endRemoveRows();
+        } else if (row >= rows.size() || fresh.at(k)->key < rows.at(row)->key) {
+            DwarfGroup *g = fresh.at(k);
+            g->parent = parent;
+            beginInsertRows(parent_idx, row, row);
+            rows.insert(row, g);
+            endInsertRows();
+            index_members(g, index(row, 0, parent_idx));
+            ++row;
+            ++k;
+        } else {
+            DwarfGroup *g = rows.at(row);
+            DwarfGroup *f = fresh.at(k);
+            QModelIndex g_idx = index(row, 0, parent_idx);
+            bool changed = g->members != f->members;
+            if (!m_grouped) {
+                // the row is the dwarf itself, and the key is its id
+                if (changed) {
+                    g->members = f->members;
+                    g->members.at(0)->m_name_idx = g_idx;
                 }
-                break;
+            } else if (is_leaf(g)) {
+                update_members(g, g_idx, f->members);
+            } else {
+                merge_groups(g, g_idx, f->children);
+                f->children.clear(); // adopted or deleted by the merge
+                g->members = f->members;
+            }
+            g->enabled_counts = f->enabled_counts;
+            g->dirty_counts = f->dirty_counts;
+            g->pref_dirty_counts = f->pref_dirty_counts;
+            if (changed)
+                row_changed(row, parent_idx); // member counts and aggregates
+            delete f;
+            ++row;
+            ++k;
         }
     }
+}
 
-    foreach(QString key, m_grouped_dwarves.uniqueKeys()) {
-        build_row(key);
+void DwarfModel::update_members(DwarfGroup *g, const QModelIndex &g_idx,
+                                const QVector<Dwarf*> &members) {
+    int i = 0;
+    int j = 0;
+    while (i < g->members.size() || j < members.size()) {
+        if (j >= members.size() ||
+            (i < g->members.size() && g->members.at(i)->id() < members.at(j)->id())) {
+            beginRemoveRows(g_idx, i, i);
+            g->members.remove(i);
+            endRemoveRows();
+        } else if (i >= g->members.size() || members.at(j)->id() < g->members.at(i)->id()) {
+            beginInsertRows(g_idx, i, i);
+            g->members.insert(i, members.at(j));
+            endInsertRows();
+            members.at(j)->m_name_idx = index(i, 0, g_idx);
+            ++i;
+            ++j;
+        } else {
+            if (g->members.at(i) != members.at(j)) { // a fresh read of the same dwarf
+                g->members[i] = members.at(j);
+                members.at(j)->m_name_idx = index(i, 0, g_idx);
+                row_changed(i, g_idx);
+            }
+            ++i;
+            ++j;
+        }
     }
 }
 
-void DwarfModel::build_row(const QString &key) {
-    QIcon icn_f(":img/female.png");
-    QIcon icn_m(":img/male.png");
-    QStandardItem *root = 0;
-    QList<QStandardItem*> root_row;
-    Dwarf *first_dwarf = m_grouped_dwarves.value(key).at(0);
-    if (!first_dwarf) {
-        LOGE << "'Group by'' set for" << key << "has a bad ref for its first "
-                << "dwarf";
+static bool id_less(const Dwarf *a, const Dwarf *b) {
+    return const_cast<Dwarf*>(a)->id() < const_cast<Dwarf*>(b)->id();
+}
+
+void DwarfModel::regroup(Dwarf *d) {
+    // pending changes can only move dwarves between these groupings, and
+    // every cached key for them has to stay true even if it isn't shown
+    static const GROUP_BY pending_modes[] = {GB_PROFESSION, GB_MILITARY_STATUS,
+                                             GB_ASSIGNED_LABORS, GB_HAS_NICKNAME};
+    bool moved = false;
+    for (int i = 0; i < 4; ++i) {
+        GROUP_BY mode = pending_modes[i];
+        QHash<int, QHash<int, int> >::iterator keys = m_group_keys.find(mode);
+        if (keys == m_group_keys.end())
+            continue;
+        int key = group_key(d, mode);
+        if (keys.value().value(d->id(), key) != key) {
+            keys.value().insert(d->id(), key);
+            if (m_rows_levels.contains(mode))
+                moved = true;
+        }
+    }
+    if (!moved || !m_grouped || !d->m_name_idx.isValid())
         return;
+
+    // out of the old leaf, dropping any groups that end up empty...
+    update_labor_counts(d);
+    LaborTally tally = m_tallies.value(d->id());
+    QModelIndex g_idx = d->m_name_idx.parent();
+    DwarfGroup *g = static_cast<DwarfGroup*>(d->m_name_idx.internalPointer());
+    for (DwarfGroup *up = g; up; up = up->parent)
+        up->count_labors(tally, -1);
+    int row = d->m_name_idx.row();
+    beginRemoveRows(g_idx, row, row);
+    g->members.remove(row);
+    endRemoveRows();
+    for (DwarfGroup *up = g->parent; up; up = up->parent) {
+        QVector<Dwarf*>::iterator it = qLowerBound(up->members.begin(), up->members.end(), d, id_less);
+        if (it != up->members.end() && *it == d)
+            up->members.erase(it);
     }
+    while (g && g->members.isEmpty()) {
+        DwarfGroup *parent = g->parent;
+        QModelIndex parent_idx = g_idx.parent();
+        beginRemoveRows(parent_idx, g_idx.row(), g_idx.row());
+        delete (parent ? parent->children : m_groups).takeAt(g_idx.row());
+        endRemoveRows();
+        g = parent;
+        g_idx = parent_idx;
+    }
+    for (; g_idx.isValid(); g_idx = g_idx.parent())
+        row_changed(g_idx.row(), g_idx.parent());
 
-    if (m_group_by != GB_NOTHING) {
-        // we need a root element to hold group members...
-        QString title = QString("%1 (%2)").arg(key).arg(m_grouped_dwarves.value(key).size());
-        root = new QStandardItem(title);
-        root->setData(true, DR_IS_AGGREGATE);
-        root->setData(key, DR_GROUP_NAME);
-        root->setData(0, DR_RATING);
-        //root->setData(title, DR_SORT_VALUE);
-        // for integer based values we want to make sure they sort by the int
-        // values instead of the string values
-        if (m_group_by == GB_MIGRATION_WAVE) {
-            root->setData(first_dwarf->migration_wave(), DR_SORT_VALUE);
-        } else if (m_group_by == GB_HIGHEST_SKILL) {
-            root->setData(first_dwarf->highest_skill().rating(), DR_SORT_VALUE);
-        } else if (m_group_by == GB_TOTAL_SKILL_LEVELS) {
-            root->setData(first_dwarf->total_skill_levels(), DR_SORT_VALUE);
-        } else if (m_group_by == GB_HAPPINESS) {
-            root->setData(first_dwarf->get_happiness(), DR_SORT_VALUE);
-        } else if (m_group_by == GB_ASSIGNED_LABORS) {
-            root->setData(first_dwarf->total_assigned_labors(), DR_SORT_VALUE);
+    // ...and into the leaf its keys lead to, creating groups on the way
+    DwarfGroup *parent = 0;
+    QModelIndex parent_idx;
+    for (int level = 0; level < m_rows_levels.size(); ++level) {
+        int key = group_keys(mode_at(level)).value(d->id());
+        QList<DwarfGroup*> &siblings = parent ? parent->children : m_groups;
+        int r = 0;
+        while (r < siblings.size() && siblings.at(r)->key < key)
+            ++r;
+        if (r == siblings.size() || siblings.at(r)->key != key) {
+            DwarfGroup *ng = new DwarfGroup;
+            ng->key = key;
+            ng->level = level;
+            ng->parent = parent;
+            beginInsertRows(parent_idx, r, r);
+            siblings.insert(r, ng);
+            endInsertRows();
+        }
+        DwarfGroup *cur = siblings.at(r);
+        QModelIndex cur_idx = index(r, 0, parent_idx);
+        QVector<Dwarf*>::iterator it = qLowerBound(cur->members.begin(), cur->members.end(), d, id_less);
+        int pos = it - cur->members.begin();
+        if (is_leaf(cur)) {
+            beginInsertRows(cur_idx, pos, pos);
+            cur->members.insert(pos, d);
+            endInsertRows();
+            d->m_name_idx = index(pos, 0, cur_idx);
+        } else {
+            cur->members.insert(pos, d); // counts only, rows are the subgroups
         }
-        root_row << root;
+        cur->count_labors(tally, 1);
+        row_changed(r, parent_idx);
+        parent = cur;
+        parent_idx = cur_idx;
     }
+}
 
-    if (root) { // we have a parent, so we should draw an aggregate row
-        foreach(ViewColumnSet *set, m_gridview->sets()) {
-            foreach(ViewColumn *col, set->columns()) {
-                QStandardItem *item = col->build_aggregate(key, m_grouped_dwarves[key]);
-                root_row << item;
+namespace {
+    //! GB_MILITARY_STATUS group keys
+    typedef enum {
+        MS_JUVENILE,
+        MS_CHAMPION,
+        MS_NOBLE,
+        MS_ACTIVE_MILITARY,
+        MS_CAN_ACTIVATE
+    } MILITARY_STATUS;
+}
+
+int DwarfModel::group_key(Dwarf *d, GROUP_BY mode) {
+    switch (mode) {
+        default:
+        case GB_NOTHING:
+            return d->id();
+        case GB_PROFESSION:
+            return label_id(d->profession());
+        case GB_LEGENDARY:
+            return d->legendary_skills() ? 1 : 0;
+        case GB_SEX:
+            return d->is_male() ? 1 : 0;
+        case GB_HAPPINESS:
+            return d->get_happiness();
+        case GB_MIGRATION_WAVE:
+            return d->migration_wave();
+        case GB_CURRENT_JOB:
+            return label_id(d->current_job());
+        case GB_MILITARY_STATUS:
+            {
+                QString prof = d->profession();
+                if (prof == "Baby" || prof == "Child")
+                    return MS_JUVENILE;
+                if (d->active_military() && !d->can_set_labors()) // epic military
+                    return MS_CHAMPION;
+                if (!d->can_set_labors())
+                    return MS_NOBLE;
+                if (d->active_military())
+                    return MS_ACTIVE_MILITARY;
+                return MS_CAN_ACTIVATE;
+                /*
+                4a) Heroes and Champions (who cannot deactivate)
+                4b) Non-Heroic Soldiers and Guards (who can deactivate)
+                4c) Civilians (who can activate)
+                4d) Juveniles (who may one day activate)
+                4e) Immigrant Nobles (who are forever off-limits)
+                */
             }
-        }
+        case GB_HIGHEST_SKILL:
+            return d->highest_skill().rating();
+        case GB_TOTAL_SKILL_LEVELS:
+            return d->total_skill_levels();
+        case GB_ASSIGNED_LABORS:
+            return d->total_assigned_labors();
+        case GB_HAS_NICKNAME:
+            return d->nickname().isEmpty() ? 0 : 1;
+        case GB_SQUAD:
+            return d->squad_name().isEmpty() ? -1 : label_id(d->squad_name());
     }
+}
 
-    foreach(Dwarf *d, m_grouped_dwarves.value(key)) {
-        QStandardItem *i_name = new QStandardItem(d->nice_name());
-        if (d->active_military()) {
-            QFont f = i_name->font();
-            f.setBold(true);
-            i_name->setFont(f);
-        }
+int DwarfModel::label_id(const QString &label) {
+    QHash<QString, int>::const_iterator it = m_label_ids.constFind(label);
+    if (it != m_label_ids.constEnd())
+        return it.value();
+    m_labels << label;
+    m_label_ids.insert(label, m_labels.size() - 1);
+    return m_labels.size() - 1;
+}
 
-        i_name->setToolTip(d->tooltip_text());
-        i_name->setStatusTip(d->nice_name());
-        i_name->setData(false, DR_IS_AGGREGATE);
-        i_name->setData(0, DR_RATING);
-        i_name->setData(d->id(), DR_ID);
-        QVariant sort_val;
-        switch(m_group_by) {
-            case GB_PROFESSION:
-                sort_val = d->raw_profession();
-                break;
-            case GB_HAPPINESS:
-                sort_val = d->get_raw_happiness();
-                break;
-            case GB_NOTHING:
-            default:
-                sort_val = d->nice_name();
-                break;
-        }
-        i_name->setData(sort_val, DR_SORT_VALUE);
+const QHash<int, int> &DwarfModel::group_keys(GROUP_BY mode) {
+    QHash<int, int> &keys = m_group_keys[mode];
+    if (keys.size() != m_dwarves.size()) {
+        keys.clear();
+        foreach(Dwarf *d, m_dwarves)
+            keys.insert(d->id(), group_key(d, mode));
+    }
+    return keys;
+}
 
-        if (d->is_male()) {
-            i_name->setIcon(icn_m);
-        } else {
-            i_name->setIcon(icn_f);
+const QString &DwarfModel::group_label(const DwarfGroup *g) const {
+    if (!g->label.isNull())
+        return g->label;
+    int key = g->key;
+    QString label;
+    switch (mode_at(g->level)) {
+        default:
+        case GB_NOTHING:
+            label = QString::number(key);
+            break;
+        case GB_PROFESSION:
+        case GB_CURRENT_JOB:
+            label = m_labels.value(key);
+            break;
+        case GB_LEGENDARY:
+            label = key ? tr("Legends") : tr("Losers");
+            break;
+        case GB_SEX:
+            label = key ? tr("Males") : tr("Females");
+            break;
+        case GB_HAPPINESS:
+            label = Dwarf::happiness_name(static_cast<Dwarf::DWARF_HAPPINESS>(key));
+            break;
+        case GB_MIGRATION_WAVE:
+            label = QString("Wave %1").arg(key);
+            break;
+        case GB_MILITARY_STATUS:
+            switch (key) {
+                case MS_JUVENILE:           label = tr("Juveniles"); break;
+                case MS_CHAMPION:           label = tr("Champions"); break;
+                case MS_NOBLE:              label = tr("Nobles"); break;
+                case MS_ACTIVE_MILITARY:    label = tr("Active Military"); break;
+                default:                    label = tr("Can Activate"); break;
+            }
+            break;
+        case GB_HIGHEST_SKILL:
+            label = GameDataReader::ptr()->get_skill_level_name(key);
+            break;
+        case GB_TOTAL_SKILL_LEVELS:
+            label = tr("Levels: %1").arg(key);
+            break;
+        case GB_ASSIGNED_LABORS:
+            label = tr("%1 Assigned Labors").arg(key);
+            break;
+        case GB_HAS_NICKNAME:
+            label = key ? tr("Has Nickname") : tr("No Nickname");
+            break;
+        case GB_SQUAD:
+            label = key < 0 ? tr("No Squad") : m_labels.value(key);
+            break;
+    }
+    if (label.isNull())
+        label = ""; // never resolve the same group twice
+    g->label = label;
+    return g->label;
+}
+
+const QString &DwarfModel::group_name(const DwarfGroup *g) const {
+    if (g->name.isNull()) {
+        g->name = g->parent ? group_name(g->parent) + " / " + group_label(g)
+                            : group_label(g);
+    }
+    return g->name;
+}
+
+DwarfModel::DwarfGroup *DwarfModel::find_group(const QString &group_name,
+                                               const QList<DwarfGroup*> &groups) const {
+    foreach(DwarfGroup *g, groups) {
+        const QString &name = this->group_name(g);
+        if (name == group_name)
+            return g;
+        if (group_name.startsWith(name + " / ")) {
+            if (DwarfGroup *found = find_group(group_name, g->children))
+                return found;
         }
+    }
+    return 0;
+}
 
-        QList<QStandardItem*> items;
-        items << i_name;
-        foreach(ViewColumnSet *set, m_gridview->sets()) {
-            foreach(ViewColumn *col, set->columns()) {
-                QStandardItem *item = col->build_cell(d);
-                items << item;
-            }
+QVector<Dwarf*> DwarfModel::group_members(const QString &group_name) const {
+    DwarfGroup *g = m_grouped ? find_group(group_name, m_groups) : 0;
+    if (!g)
+        return QVector<Dwarf*>();
+    return g->members;
+}
+
+void DwarfModel::partition(const QVector<Dwarf*> &dwarves, GROUP_BY mode,
+                           QVector<int> &keys, QVector<QVector<Dwarf*> > &buckets) {
+    const QHash<int, int> &key_of = group_keys(mode);
+
+    // counting sort: size each bucket, lay the buckets out in key order and
+    // drop the dwarves (already in id order) into them
+    QHash<int, int> counts;
+    foreach(Dwarf *d, dwarves)
+        ++counts[key_of.value(d->id())];
+    keys = counts.keys().toVector();
+    qSort(keys);
+
+    QHash<int, int> bucket_of_key;
+    buckets.clear();
+    buckets.resize(keys.size());
+    for (int i = 0; i < keys.size(); ++i) {
+        int key = keys.at(i);
+        bucket_of_key.insert(key, i);
+        buckets[i].reserve(counts.value(key));
+    }
+    foreach(Dwarf *d, dwarves)
+        buckets[bucket_of_key.value(key_of.value(d->id()))].append(d);
+}
+
+void DwarfModel::forget_pending_group_keys() {
+    // custom professions, nicknames and labor toggles move dwarves between
+    // these groups; the rest only change with a fresh read
+    m_group_keys.remove(GB_PROFESSION);
+    m_group_keys.remove(GB_MILITARY_STATUS);
+    m_group_keys.remove(GB_ASSIGNED_LABORS);
+    m_group_keys.remove(GB_HAS_NICKNAME);
+}
+
+void DwarfModel::begin_changes() {
+    ++m_batch_depth;
+}
+
+void DwarfModel::end_changes() {
+    if (--m_batch_depth > 0)
+        return;
+
+    // sort the touched rows by parent (rows may have moved since they were
+    // touched, so only now are their indexes final)...
+    QMap<QModelIndex, QList<int> > rows;
+    foreach(Dwarf *d, m_changed_dwarves) {
+        update_pending_count(d);
+        update_labor_counts(d);
+        if (d->m_name_idx.isValid())
+            rows[d->m_name_idx.parent()] << d->m_name_idx.row();
+    }
+    foreach(const QPersistentModelIndex &idx, m_changed_groups) {
+        if (idx.isValid()) // the group may have been dropped
+            rows[idx.parent()] << idx.row();
+    }
+    m_changed_dwarves.clear();
+    m_changed_groups.clear();
+
+    // ...and emit each run of neighbouring rows as one range
+    int last_col = columnCount() - 1;
+    for (QMap<QModelIndex, QList<int> >::iterator it = rows.begin(); it != rows.end(); ++it) {
+        QList<int> &r = it.value();
+        qSort(r);
+        int first = r.at(0);
+        for (int i = 1; i <= r.size(); ++i) {
+            if (i < r.size() && r.at(i) <= r.at(i - 1) + 1)
+                continue;
+            emit dataChanged(index(first, 0, it.key()), index(r.at(i - 1), last_col, it.key()));
+            if (i < r.size())
+                first = r.at(i);
         }
+    }
+}
 
-        if (root) {
-            root->appendRow(items);
-        } else {
-            appendRow(items);
+void DwarfModel::row_changed(int row, const QModelIndex &parent) {
+    QModelIndex idx = index(row, 0, parent);
+    if (!idx.isValid())
+        return;
+    begin_changes();
+    if (Dwarf *d = dwarf_at(idx))
+        m_changed_dwarves.insert(d);
+    else
+        m_changed_groups << QPersistentModelIndex(idx);
+    end_changes();
+}
+
+void DwarfModel::group_changed(const QModelIndex &g_idx) {
+    begin_changes();
+    for (QModelIndex up = g_idx; up.isValid(); up = up.parent())
+        row_changed(up.row(), up.parent()); // counts and aggregates
+    QList<QModelIndex> pending;
+    pending << g_idx;
+    while (!pending.isEmpty()) {
+        QModelIndex parent = pending.takeLast();
+        for (int row = 0; row < rowCount(parent); ++row) {
+            row_changed(row, parent);
+            QModelIndex child = index(row, 0, parent);
+            if (is_group(child))
+                pending << child;
         }
-        d->m_name_idx = indexFromItem(i_name);
     }
-    if (root) {
-        appendRow(root_row);
+    end_changes();
+}
+
+void DwarfModel::update_pending_count(Dwarf *d) {
+    int count = d->pending_changes();
+    m_pending_total += count - m_pending_counts.value(d->id());
+    if (count)
+        m_pending_counts.insert(d->id(), count);
+    else
+        m_pending_counts.remove(d->id());
+}
+
+void DwarfModel::update_labor_counts(Dwarf *d) {
+    if (!m_grouped)
+        return;
+    LaborTally now = tally_of(d);
+    LaborTally &counted = m_tallies[d->id()];
+    if (now == counted)
+        return;
+    // the dwarf's row points at its innermost group
+    DwarfGroup *g = d->m_name_idx.isValid()
+            ? static_cast<DwarfGroup*>(d->m_name_idx.internalPointer()) : 0;
+    for (; g; g = g->parent) {
+        g->count_labors(counted, -1);
+        g->count_labors(now, 1);
+    }
+    counted = now;
+}
+
+bool DwarfModel::is_group(const QModelIndex &idx) const {
+    return group_at(idx) != 0;
+}
+
+DwarfModel::DwarfGroup *DwarfModel::group_at(const QModelIndex &idx) const {
+    if (!m_grouped || !idx.isValid())
+        return 0;
+    DwarfGroup *parent = static_cast<DwarfGroup*>(idx.internalPointer());
+    if (!parent)
+        return m_groups.at(idx.row());
+    if (is_leaf(parent)) // a dwarf
+        return 0;
+    return parent->children.at(idx.row());
+}
+
+QModelIndex DwarfModel::group_index(const DwarfGroup *g) const {
+    const QList<DwarfGroup*> &siblings = g->parent ? g->parent->children : m_groups;
+    return createIndex(siblings.indexOf(const_cast<DwarfGroup*>(g)), 0, g->parent);
+}
+
+Dwarf *DwarfModel::dwarf_at(const QModelIndex &idx) const {
+    if (!idx.isValid())
+        return 0;
+    DwarfGroup *g = static_cast<DwarfGroup*>(idx.internalPointer());
+    if (!g) // a top level group header, or a dwarf when not grouping
+        return m_grouped ? 0 : m_groups.at(idx.row())->members.at(0);
+    if (!is_leaf(g)) // a subgroup header
+        return 0;
+    return g->members.at(idx.row());
+}
+
+const void *DwarfModel::row_owner(const QModelIndex &idx) const {
+    const void *owner = dwarf_at(idx);
+    if (!owner)
+        owner = group_at(idx);
+    return owner;
+}
+
+QModelIndex DwarfModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < 0 || column < 0 || column >= columnCount())
+        return QModelIndex();
+    if (!parent.isValid()) {
+        if (row >= m_groups.size())
+            return QModelIndex();
+        return createIndex(row, column);
+    }
+    // only group headers have children, and only under their name column
+    if (!is_group(parent) || parent.column() != 0)
+        return QModelIndex();
+    DwarfGroup *g = group_at(parent);
+    if (row >= (is_leaf(g) ? g->members.size() : g->children.size()))
+        return QModelIndex();
+    return createIndex(row, column, g); // children point at their group
+}
+
+QModelIndex DwarfModel::parent(const QModelIndex &child) const {
+    if (!child.isValid() || !child.internalPointer())
+        return QModelIndex();
+    return group_index(static_cast<DwarfGroup*>(child.internalPointer()));
+}
+
+int DwarfModel::rowCount(const QModelIndex &parent) const {
+    if (!parent.isValid())
+        return m_groups.size();
+    if (parent.column() != 0)
+        return 0;
+    DwarfGroup *g = group_at(parent);
+    if (!g)
+        return 0;
+    return is_leaf(g) ? g->members.size() : g->children.size();
+}
+
+int DwarfModel::columnCount(const QModelIndex &) const {
+    return m_columns.size() + 1;
+}
+
+Qt::ItemFlags DwarfModel::flags(const QModelIndex &idx) const {
+    if (!idx.isValid())
+        return 0;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+QVariant DwarfModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || section < 1 || section > m_columns.size())
+        return QAbstractItemModel::headerData(section, orientation, role);
+    ViewColumn *col = m_columns.at(section - 1);
+    if (!col)
+        return QVariant();
+    switch (role) {
+        case Qt::DisplayRole:
+            return col->title();
+        case Qt::BackgroundColorRole:
+            return col->bg_color();
+        case Qt::UserRole:
+            return col->set() ? col->set()->name() : QString();
+        default:
+            return QVariant();
+    }
+}
+
+QVariant DwarfModel::data(const QModelIndex &idx, int role) const {
+    if (!idx.isValid())
+        return QVariant();
+    if (role != Qt::ToolTipRole)
+        return cell_value(idx, role);
+
+    QPair<const void*, int> key(row_owner(idx), idx.column());
+    if (QString *cached = m_tooltips.object(key))
+        return *cached;
+    QVariant tip = cell_value(idx, role);
+    if (tip.isValid())
+        m_tooltips.insert(key, new QString(tip.toString()));
+    return tip;
+}
+
+void DwarfModel::clear_tooltips() {
+    m_tooltips.clear();
+}
+
+void DwarfModel::group_labor_counts(const QModelIndex &group_idx, int labor_id,
+                                    int &members, int &enabled, int &dirty) const {
+    members = enabled = dirty = 0;
+    DwarfGroup *g = group_at(group_idx);
+    if (!g)
+        return;
+    if (labor_id < 0 || labor_id >= LaborSet::MAX_LABORS)
+        return;
+    members = g->members.size();
+    enabled = g->enabled_counts.at(labor_id);
+    // a preference column shares its id with a labor now and then
+    ViewColumn *col = group_idx.column() > 0 ? m_columns.value(group_idx.column() - 1) : 0;
+    if (col && col->type() == CT_MILITARY_PREFERENCE)
+        dirty = g->pref_dirty_counts.at(labor_id);
+    else
+        dirty = g->dirty_counts.at(labor_id);
+}
+
+QVariant DwarfModel::cell_value(const QModelIndex &idx, int role) const {
+    ViewColumn *col = 0;
+    if (idx.column() > 0) {
+        col = m_columns.at(idx.column() - 1);
+        if (!col) // the view was deleted out from under us
+            return QVariant();
+    }
+
+    if (const DwarfGroup *g = group_at(idx)) {
+        if (!col)
+            return group_data(g, role);
+        return col->aggregate_data(group_name(g), g->members, role);
+    }
+
+    Dwarf *d = dwarf_at(idx);
+    if (!d)
+        return QVariant();
+    if (!col)
+        return name_data(d, role);
+    return col->cell_data(d, role);
+}
+
+QVariant DwarfModel::group_data(const DwarfGroup *g, int role) const {
+    switch (role) {
+        case Qt::DisplayRole:
+            return QString("%1 (%2)").arg(group_label(g)).arg(g->members.size());
+        case DR_IS_AGGREGATE:
+            return true;
+        case DR_GROUP_NAME:
+            return group_name(g);
+        case DR_RATING:
+            return 0;
+        case DR_SORT_VALUE:
+            // for integer based values we want to make sure they sort by
+            // the int values instead of the string values
+            switch (mode_at(g->level)) {
+                case GB_MIGRATION_WAVE:
+                case GB_HIGHEST_SKILL:
+                case GB_TOTAL_SKILL_LEVELS:
+                case GB_HAPPINESS:
+                case GB_ASSIGNED_LABORS:
+                    return g->key;
+                default:
+                    return QVariant();
+            }
+        default:
+            return QVariant();
+    }
+}
+
+QVariant DwarfModel::name_data(Dwarf *d, int role) const {
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::StatusTipRole:
+            return d->nice_name();
+        case Qt::ToolTipRole:
+            return d->tooltip_text();
+        case Qt::DecorationRole:
+            return d->is_male() ? m_icn_male : m_icn_female;
+        case Qt::FontRole:
+            if (d->active_military()) {
+                QFont f;
+                f.setBold(true);
+                return f;
+            }
+            return QVariant();
+        case DR_IS_AGGREGATE:
+            return false;
+        case DR_RATING:
+            return 0;
+        case DR_ID:
+            return d->id();
+        case DR_SORT_VALUE:
+            // dwarves are listed under the innermost grouping
+            switch(mode_at(m_rows_levels.size() - 1)) {
+                case GB_PROFESSION:
+                    return d->raw_profession();
+                case GB_HAPPINESS:
+                    return d->get_raw_happiness();
+                case GB_NOTHING:
+                default:
+                    return d->nice_name();
+            }
+        default:
+            return QVariant();
     }
 }
 
 void DwarfModel::cell_activated(const QModelIndex &idx) {
-    QStandardItem *item = itemFromIndex(idx);
-    bool is_aggregate = item->data(DR_IS_AGGREGATE).toBool();
+    bool is_aggregate = idx.data(DR_IS_AGGREGATE).toBool();
     if (idx.column() == 0) {
         if (is_aggregate)
             return; // no double clicking aggregate names
-        int dwarf_id = item->data(DR_ID).toInt(); // TODO: handle no id
+        int dwarf_id = idx.data(DR_ID).toInt(); // TODO: handle no id
         if (!dwarf_id) {
             LOGW << "double clicked what should have been a dwarf name, but the ID wasn't set!";
             return;
@@ -399,19 +1003,19 @@ void DwarfModel::cell_activated(const QModelIndex &idx) {
     if (type != CT_LABOR && type != CT_MILITARY_PREFERENCE)
         return;
 
-    Q_ASSERT(item);
-
-    int labor_id = item->data(DR_LABOR_ID).toInt();
-    int dwarf_id = item->data(DR_ID).toInt(); // TODO: handle no id
+    int labor_id = idx.data(DR_LABOR_ID).toInt();
+    int dwarf_id = idx.data(DR_ID).toInt(); // TODO: handle no id
+    begin_changes();
     if (is_aggregate) {
         QModelIndex first_col = idx.sibling(idx.row(), 0);
+        // a copy, regrouping may move dwarves out of this group (or delete it)
+        QVector<Dwarf*> members = group_at(idx)->members;
 
         // first find out how many are enabled...
         int enabled_count = 0;
         int settable_dwarves = 0;
-        QString group_name = idx.data(DwarfModel::DR_GROUP_NAME).toString();
 
-        foreach(Dwarf *d, m_grouped_dwarves.value(group_name)) {
+        foreach(Dwarf *d, members) {
             if (d->can_set_labors() || DT->labor_cheats_allowed()) {
                 settable_dwarves++;
                 if (d->labor_enabled(labor_id))
@@ -421,50 +1025,75 @@ void DwarfModel::cell_activated(const QModelIndex &idx) {
 
         // if none or some are enabled, enable all of them
         bool enabled = (enabled_count < settable_dwarves);
-        foreach(Dwarf *d, m_grouped_dwarves.value(group_name)) {
+        foreach(Dwarf *d, members) {
             d->set_labor(labor_id, enabled);
         }
 
-        // tell the view what we touched...
-        emit dataChanged(idx, idx);
-        QModelIndex left = index(0, 0, first_col);
-        QModelIndex right = index(rowCount(first_col) - 1, columnCount(first_col) - 1, first_col);
-        emit dataChanged(left, right); // tell the view we changed every dwarf under this agg to pick up implicit exclusive changes
+        // tell the view what we touched (every dwarf under this agg, to pick
+        // up implicit exclusive changes, and the aggs above it)...
+        group_changed(first_col);
+        foreach(Dwarf *d, members) {
+            regroup(d);
+        }
     } else {
         if (!dwarf_id) {
             LOGW << "dwarf_id was 0 for cell at" << idx << "!";
         } else {
-            QModelIndex left = index(idx.parent().row(), 0, idx.parent().parent());
-            QModelIndex right = index(idx.parent().row(), columnCount(idx.parent()) - 1, idx.parent().parent());
-            emit dataChanged(left, right); // update the agg row
-
-            left = index(idx.row(), 0, idx.parent());
-            right = index(idx.row(), columnCount(idx.parent()) - 1, idx.parent());
-            emit dataChanged(left, right); // update the dwarf row
+            Dwarf *d = m_dwarves[dwarf_id];
             if (type == CT_LABOR)
-                m_dwarves[dwarf_id]->toggle_labor(labor_id);
+                d->toggle_labor(labor_id);
             else if (type == CT_MILITARY_PREFERENCE)
-                m_dwarves[dwarf_id]->toggle_pref_value(labor_id);
+                d->toggle_pref_value(labor_id);
 
+            row_changed(idx.row(), idx.parent()); // update the dwarf row
+            for (QModelIndex up = idx.parent(); up.isValid(); up = up.parent())
+                row_changed(up.row(), up.parent()); // and the agg rows above it
+            regroup(d);
         }
     }
+    end_changes();
     calculate_pending();
     TRACE << "toggling" << labor_id << "for dwarf:" << dwarf_id;
 }
 
+void DwarfModel::set_grid_views(const QList<GridView*> &views) {
+    m_gridviews.clear();
+    foreach(GridView *v, views) {
+        if (!m_gridviews.contains(v))
+            m_gridviews << v;
+    }
+}
+
+bool DwarfModel::view_columns(const GridView *v, int &first, int &count) const {
+    QHash<const GridView*, QPair<int, int> >::const_iterator it = m_view_columns.constFind(v);
+    if (it == m_view_columns.constEnd())
+        return false;
+    first = it.value().first;
+    count = it.value().second;
+    return true;
+}
+
 void DwarfModel::set_group_by(int group_by) {
-    LOGD << "group_by now set to" << group_by;
-    m_group_by = static_cast<GROUP_BY>(group_by);
+    QList<int> levels;
+    if (group_by != GB_NOTHING)
+        levels << group_by;
+    set_group_levels(levels);
+}
+
+void DwarfModel::set_group_levels(const QList<int> &levels) {
+    LOGD << "group_by now set to" << levels;
+    m_group_levels.clear();
+    foreach(int group_by, levels) {
+        m_group_levels << static_cast<GROUP_BY>(group_by);
+    }
     if (m_df)
         build_rows();
 }
 
 void DwarfModel::calculate_pending() {
-    int changes = 0;
-    foreach(Dwarf *d, m_dwarves) {
-        changes += d->pending_changes();
-    }
-    emit new_pending_changes(changes);
+    // every change goes through row_changed(), which recounts the dwarves
+    // it touched, so the total is already known
+    emit new_pending_changes(m_pending_total);
 }
 
 void DwarfModel::clear_pending() {
@@ -473,6 +1102,9 @@ void DwarfModel::clear_pending() {
             d->clear_pending();
         }
     }
+    m_pending_counts.clear();
+    m_pending_total = 0;
+    forget_pending_group_keys();
     //reset();
     emit new_pending_changes(0);
     emit need_redraw();
@@ -490,9 +1122,11 @@ void DwarfModel::commit_pending() {
 }
 
 QVector<Dwarf*> DwarfModel::get_dirty_dwarves() {
+    QList<int> ids = m_pending_counts.keys();
+    qSort(ids);
     QVector<Dwarf*> dwarves;
-    foreach(Dwarf *d, m_dwarves) {
-        if (d->pending_changes())
+    foreach(int id, ids) {
+        if (Dwarf *d = m_dwarves.value(id))
             dwarves.append(d);
     }
     return dwarves;
@@ -533,33 +1167,28 @@ bool DwarfModel::compare_turn_count(const Dwarf *a, const Dwarf *b) {
 }
 
 void DwarfModel::dwarf_group_toggled(const QString &group_name) {
-    QModelIndex agg_cell = findOne(group_name, DR_GROUP_NAME);
-    if (agg_cell.isValid()) {
-        QModelIndex left = agg_cell;
-        QModelIndex right = index(agg_cell.row(), columnCount(agg_cell.parent()) -1, agg_cell.parent());
-        emit dataChanged(left, right);
-    }
-    foreach (Dwarf *d, m_grouped_dwarves[group_name]) {
-        foreach(QModelIndex idx, findAll(d->id(), DR_ID, 0, agg_cell)) {
-            QModelIndex left = idx;
-            QModelIndex right = index(idx.row(), columnCount(idx.parent()) - 1, idx.parent());
-            emit dataChanged(left, right);
-        }
+    DwarfGroup *g = m_grouped ? find_group(group_name, m_groups) : 0;
+    if (!g)
+        return;
+    QVector<Dwarf*> members = g->members; // regrouping may delete g
+    begin_changes();
+    group_changed(group_index(g));
+    foreach(Dwarf *d, members) {
+        regroup(d);
     }
+    end_changes();
 }
 
 void DwarfModel::dwarf_set_toggled(Dwarf *d) {
-    // just update all cells we can find with this dwarf's id
-    QList<QPersistentModelIndex> cells = findAll(d->id(), DR_ID, 0);
-    foreach(QPersistentModelIndex idx, cells) {
-        QModelIndex left = idx;
-        QModelIndex right = index(idx.row(), columnCount(idx.parent()) - 1, idx.parent());
-        emit dataChanged(left, right);
-    }
-    if (cells.size()) {
-        QPersistentModelIndex first_idx = cells.at(0);
-        QModelIndex left = first_idx.parent();
-        QModelIndex right = index(left.row(), columnCount(left) - 1, left.parent());
-        emit dataChanged(left, right);
+    begin_changes();
+    regroup(d);
+    // the dwarf knows its row, so only it and its groups' aggregates repaint
+    if (d->m_name_idx.isValid()) {
+        row_changed(d->m_name_idx.row(), d->m_name_idx.parent());
+        for (QModelIndex up = d->m_name_idx.parent(); up.isValid(); up = up.parent())
+            row_changed(up.row(), up.parent());
+    } else {
+        m_changed_dwarves.insert(d); // not shown, but its pending count changed
     }
+    end_changes();
 }
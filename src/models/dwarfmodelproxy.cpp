@@ -27,14 +27,77 @@ THE SOFTWARE.
 #include "dwarfmodel.h"
 #include "dwarf.h"
 #include "profession.h"
+#include "gamedatareader.h"
 #include "defines.h"
 #include "dwarftherapist.h"
 #include "mainwindow.h"
+#include "truncatingfilelogger.h"
 
 DwarfModelProxy::DwarfModelProxy(QObject *parent)
     :QSortFilterProxyModel(parent)
     , m_engine(new QScriptEngine(this))
-{}
+    , m_script_stale(true)
+    , m_sort_order(Qt::AscendingOrder)
+{
+    compile_filter();
+    connect(DT, SIGNAL(settings_changed()), this, SLOT(read_settings()));
+}
+
+void DwarfModelProxy::setSourceModel(QAbstractItemModel *model) {
+    QSortFilterProxyModel::setSourceModel(model);
+    // names can change (or dwarves be replaced) whenever the rows do
+    connect(model, SIGNAL(modelReset()), SLOT(clear_name_index()));
+    connect(model, SIGNAL(rowsInserted(const QModelIndex&, int, int)),
+            SLOT(clear_name_index()));
+    connect(model, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+            SLOT(clear_name_index()));
+    // inserted rows are scripted as they arrive and changed rows are
+    // re-scripted when next asked about, but a reset needs a new pass
+    connect(model, SIGNAL(modelReset()), SLOT(script_results_stale()));
+    connect(model, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+            SLOT(forget_script_results(const QModelIndex&, const QModelIndex&)));
+    // sort keys are built once per refresh, any change to the rows drops them.
+    // Row changes drop them before they happen, since the base class places
+    // inserted rows from its own rowsInserted slot, which runs before ours
+    connect(model, SIGNAL(modelReset()), SLOT(clear_sort_keys()));
+    connect(model, SIGNAL(layoutChanged()), SLOT(clear_sort_keys()));
+    connect(model, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+            SLOT(clear_sort_keys()));
+    connect(model, SIGNAL(rowsAboutToBeInserted(const QModelIndex&, int, int)),
+            SLOT(clear_sort_keys()));
+    connect(model, SIGNAL(rowsAboutToBeRemoved(const QModelIndex&, int, int)),
+            SLOT(clear_sort_keys()));
+}
+
+void DwarfModelProxy::read_settings() {
+    clear_name_index(); // name display options may have changed
+    clear_sort_keys();
+    compile_filter();
+    invalidateFilter();
+}
+
+void DwarfModelProxy::clear_name_index() {
+    m_lower_names.clear();
+}
+
+void DwarfModelProxy::compile_filter() {
+    QSettings *s = DT->user_settings();
+    m_predicate.hide_children = s->value("options/hide_children_and_babies",
+                                         false).toBool();
+    m_predicate.baby_id = -1;
+    m_predicate.child_id = -1;
+    foreach(Profession *p, GameDataReader::ptr()->get_professions()) {
+        if (p->name(true) == "Baby") {
+            m_predicate.baby_id = p->id();
+        }
+        if (p->name(true) == "Child") {
+            m_predicate.child_id = p->id();
+        }
+        if(m_predicate.baby_id > 0 && m_predicate.child_id > 0)
+            break;
+    }
+    m_predicate.text = m_filter_text.toLower();
+}
 
 DwarfModel* DwarfModelProxy::get_dwarf_model() const {
     return static_cast<DwarfModel*>(sourceModel());
@@ -49,77 +112,126 @@ void DwarfModelProxy::cell_activated(const QModelIndex &idx) {
 
 void DwarfModelProxy::setFilterFixedString(const QString &pattern) {
     m_filter_text = pattern;
+    compile_filter();
     QSortFilterProxyModel::setFilterFixedString(pattern);
 }
 
 void DwarfModelProxy::apply_script(const QString &script_body) {
     m_active_filter_script = script_body;
+    // simple comparisons run natively, anything else goes to QtScript
+    m_filter_expression = DwarfExpression(script_body);
+#if QT_VERSION >= 0x040700
+    m_script_program = QScriptProgram(script_body);
+#endif
+    m_script_stale = true;
     invalidateFilter();
 }
 
-bool DwarfModelProxy::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const {
-    bool matches = true;
+void DwarfModelProxy::script_results_stale() {
+    m_script_stale = true;
+}
 
-    int dwarf_id = 0;
-    QSettings *s = DT->user_settings();
+void DwarfModelProxy::forget_script_results(const QModelIndex &top_left,
+                                            const QModelIndex &bottom_right) {
     const DwarfModel *m = get_dwarf_model();
-    if (m->current_grouping() == DwarfModel::GB_NOTHING) {
-        QModelIndex idx = m->index(source_row, 0, source_parent);
-        dwarf_id = m->data(idx, DwarfModel::DR_ID).toInt();
-        QString data = m->data(idx, filterRole()).toString();
-        if (!m_filter_text.isEmpty())
-            matches = matches && data.contains(m_filter_text, Qt::CaseInsensitive);
+    for (int row = top_left.row(); row <= bottom_right.row(); ++row) {
+        Dwarf *d = m->dwarf_at(m->index(row, 0, top_left.parent()));
+        if (d && d->id() >= 0 && d->id() < m_script_done.size())
+            m_script_done.clearBit(d->id());
+    }
+}
+
+void DwarfModelProxy::record_script_result(Dwarf *d) const {
+    int id = d->id();
+    if (id >= m_script_done.size()) {
+        m_script_done.resize(id + 1);
+        m_script_accepted.resize(id + 1);
+    }
+    bool accepted;
+    if (m_filter_expression.is_valid()) {
+        accepted = m_filter_expression.matches(d);
     } else {
-        QModelIndex tmp_idx = m->index(source_row, 0, source_parent);
-        QStandardItem *item = m->itemFromIndex(tmp_idx);
-        if (m->data(tmp_idx, DwarfModel::DR_IS_AGGREGATE).toBool()) {
-            int matches = 0;
-            for(int i = 0; i < item->rowCount(); ++i) {
-                if (filterAcceptsRow(i, tmp_idx)) // a child matches
-                    matches++;
+        QScriptValue d_obj = m_engine->newQObject(d);
+        m_engine->globalObject().setProperty("d", d_obj);
+#if QT_VERSION >= 0x040700
+        accepted = m_engine->evaluate(m_script_program).toBool();
+#else
+        accepted = m_engine->evaluate(m_active_filter_script).toBool();
+#endif
+    }
+    m_script_done.setBit(id);
+    m_script_accepted.setBit(id, accepted);
+}
+
+bool DwarfModelProxy::script_accepts(Dwarf *d) const {
+    if (m_script_stale) {
+        // run the script over every dwarf in one go; expanding, collapsing
+        // and sorting then only look results up
+        m_script_stale = false;
+        m_script_done.fill(false);
+        m_script_accepted.fill(false);
+        QList<Dwarf*> dwarves = get_dwarf_model()->get_dwarves();
+        if (m_filter_expression.is_valid()) {
+            QVector<double> results = m_filter_expression.values(dwarves);
+            for (int i = 0; i < dwarves.size(); ++i) {
+                int id = dwarves.at(i)->id();
+                if (id < 0)
+                    continue;
+                if (id >= m_script_done.size()) {
+                    m_script_done.resize(id + 1);
+                    m_script_accepted.resize(id + 1);
+                }
+                m_script_done.setBit(id);
+                m_script_accepted.setBit(id, results.at(i) != 0);
             }
-            matches = matches && matches > 0;
         } else {
-            QModelIndex idx = m->index(source_row, 0, source_parent);
-            dwarf_id = m->data(idx, DwarfModel::DR_ID).toInt();
-            QString data = m->data(idx, filterRole()).toString();
-            if (!m_filter_text.isEmpty())
-                matches = matches && data.contains(m_filter_text, Qt::CaseInsensitive);
+            foreach(Dwarf *dwarf, dwarves) {
+                if (dwarf->id() >= 0)
+                    record_script_result(dwarf);
+            }
         }
     }
+    int id = d->id();
+    if (id < 0)
+        return false;
+    if (id >= m_script_done.size() || !m_script_done.testBit(id))
+        record_script_result(d); // a row that arrived after the last pass
+    return m_script_accepted.testBit(id);
+}
 
-    if (dwarf_id && !m_active_filter_script.isEmpty()) {
-        Dwarf *d = m->get_dwarf_by_id(dwarf_id);
-        if (d) {
-            QScriptValue d_obj = m_engine->newQObject(d);
-            m_engine->globalObject().setProperty("d", d_obj);
-            matches = matches && m_engine->evaluate(m_active_filter_script).toBool();
-        }
+bool DwarfModelProxy::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const {
+    const DwarfModel *m = get_dwarf_model();
+    QModelIndex idx = m->index(source_row, 0, source_parent);
+    Dwarf *d = m->dwarf_at(idx);
+    if (d)
+        return accepts_dwarf(d);
+
+    // a group row stays as long as any of its members do
+    for(int i = 0; i < m->rowCount(idx); ++i) {
+        if (filterAcceptsRow(i, idx))
+            return true;
     }
+    return false;
+}
 
+bool DwarfModelProxy::accepts_dwarf(Dwarf *d) const {
     //filter children and babies if necessary
-    bool hide_children = s->value("options/hide_children_and_babies",
-                                       false).toBool();
-    if(dwarf_id && hide_children) {
-        Dwarf *d = m->get_dwarf_by_id(dwarf_id);
-
-        short baby_id = -1;
-        short child_id = -1;
-        foreach(Profession *p, GameDataReader::ptr()->get_professions()) {
-            if (p->name(true) == "Baby") {
-                baby_id = p->id();
-            }
-            if (p->name(true) == "Child") {
-                child_id = p->id();
-            }
-            if(baby_id > 0 && child_id > 0)
-                break;
-        }
-        matches = (d->raw_profession() != baby_id &&
-                   d->raw_profession() != child_id);
+    if (m_predicate.hide_children &&
+        (d->raw_profession() == m_predicate.baby_id ||
+         d->raw_profession() == m_predicate.child_id))
+        return false;
+
+    if (!m_predicate.text.isEmpty()) {
+        QHash<const Dwarf*, QString>::const_iterator it = m_lower_names.constFind(d);
+        if (it == m_lower_names.constEnd())
+            it = m_lower_names.insert(d, d->nice_name().toLower());
+        if (!it.value().contains(m_predicate.text))
+            return false;
     }
 
-    return matches;
+    if (!m_active_filter_script.isEmpty() && !script_accepts(d))
+        return false;
+    return true;
 }
 
 bool DwarfModelProxy::filterAcceptsColumn(int source_column, const QModelIndex &source_parent) const {
@@ -135,7 +247,150 @@ void DwarfModelProxy::sort(int column, Qt::SortOrder order) {
         sort(column, DSR_NAME_DESC);
 }
 
+void DwarfModelProxy::sort_by_expression(const QString &expression, Qt::SortOrder order) {
+    DwarfExpression e(expression);
+    if (!e.is_valid()) {
+        LOGW << "not sorting by invalid expression" << expression << ":" << e.error();
+        return;
+    }
+    m_sort_expression = e;
+    m_sort_keys.clear();
+    QList<Dwarf*> dwarves = get_dwarf_model()->get_dwarves();
+    QVector<double> keys = e.values(dwarves);
+    for (int i = 0; i < dwarves.size(); ++i)
+        m_sort_keys.insert(dwarves.at(i), keys.at(i));
+
+    // ties (and group rows) go alphabetically
+    m_sort_order = order;
+    m_sort_chain.clear();
+    m_sort_chain << SortColumn(0, DwarfModel::DR_SORT_VALUE, Qt::AscendingOrder);
+    setSortRole(DwarfModel::DR_SORT_VALUE);
+    QSortFilterProxyModel::sort(0, order);
+}
+
+void DwarfModelProxy::add_sort_column(int column) {
+    if (m_sort_chain.isEmpty()) {
+        sort(column, column == 0 ? DSR_NAME_ASC : DSR_NAME_DESC);
+        return;
+    }
+    bool found = false;
+    for (int i = 0; i < m_sort_chain.size(); ++i) {
+        SortColumn &sc = m_sort_chain[i];
+        if (sc.column == column) { // clicked again, flip it
+            sc.order = sc.order == Qt::AscendingOrder ? Qt::DescendingOrder
+                                                      : Qt::AscendingOrder;
+            if (i == 0)
+                m_sort_order = sc.order;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        // same default direction as a plain header click
+        m_sort_chain << SortColumn(column, DwarfModel::DR_SORT_VALUE,
+                                   column == 0 ? Qt::AscendingOrder : Qt::DescendingOrder);
+    }
+    QSortFilterProxyModel::sort(sortColumn(), m_sort_order);
+}
+
+void DwarfModelProxy::clear_sort_keys() {
+    m_sort_keys.clear();
+    m_column_keys.clear();
+}
+
+double DwarfModelProxy::sort_key(Dwarf *d) const {
+    QHash<const Dwarf*, double>::const_iterator it = m_sort_keys.constFind(d);
+    if (it == m_sort_keys.constEnd())
+        it = m_sort_keys.insert(d, m_sort_expression.value(d));
+    return it.value();
+}
+
+static bool collates_before(const QString &a, const QString &b) {
+    return QString::localeAwareCompare(a, b) < 0;
+}
+
+void DwarfModelProxy::build_column_keys(int column, int role) const {
+    const DwarfModel *m = get_dwarf_model();
+    QHash<RowId, SortKey> &keys = m_column_keys[qMakePair(column, role)];
+    QHash<RowId, QString> texts;
+
+    // every row, top level and nested, in one pass
+    QList<QModelIndex> parents;
+    parents << QModelIndex();
+    while (!parents.isEmpty()) {
+        QModelIndex parent = parents.takeLast();
+        for (int row = 0; row < m->rowCount(parent); ++row) {
+            QModelIndex name_idx = m->index(row, 0, parent);
+            if (m->rowCount(name_idx))
+                parents << name_idx;
+            QModelIndex idx = m->index(row, column, parent);
+            QVariant v = m->data(idx, role);
+            if (!v.isValid())
+                v = m->data(idx, Qt::DisplayRole);
+            RowId id = m->row_owner(idx);
+            if (v.type() == QVariant::String) {
+                texts.insert(id, v.toString().toLower());
+            } else {
+                SortKey k = {false, v.toDouble()};
+                keys.insert(id, k);
+            }
+        }
+    }
+
+    // collate each distinct string once and sort texts by their rank
+    QStringList distinct = texts.values().toSet().toList();
+    qSort(distinct.begin(), distinct.end(), collates_before);
+    QHash<QString, int> ranks;
+    int rank = 0;
+    for (int i = 0; i < distinct.size(); ++i) {
+        if (i > 0 && QString::localeAwareCompare(distinct.at(i - 1), distinct.at(i)) != 0)
+            ++rank;
+        ranks.insert(distinct.at(i), rank);
+    }
+    for (QHash<RowId, QString>::const_iterator it = texts.constBegin(); it != texts.constEnd(); ++it) {
+        SortKey k = {true, ranks.value(it.value())};
+        keys.insert(it.key(), k);
+    }
+}
+
+DwarfModelProxy::SortKey DwarfModelProxy::column_key(const QModelIndex &idx, const SortColumn &sc) const {
+    QPair<int, int> col_role(sc.column, sc.role);
+    QHash<QPair<int, int>, QHash<RowId, SortKey> >::const_iterator col = m_column_keys.constFind(col_role);
+    if (col == m_column_keys.constEnd()) {
+        build_column_keys(sc.column, sc.role);
+        col = m_column_keys.constFind(col_role);
+    }
+    SortKey none = {true, -1};
+    return col.value().value(get_dwarf_model()->row_owner(idx), none);
+}
+
+bool DwarfModelProxy::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+    if (m_sort_expression.is_valid() && left.column() == 0) {
+        const DwarfModel *m = get_dwarf_model();
+        Dwarf *l = m->dwarf_at(left);
+        Dwarf *r = m->dwarf_at(right);
+        if (l && r) {
+            double l_key = sort_key(l);
+            double r_key = sort_key(r);
+            if (l_key != r_key)
+                return l_key < r_key;
+        }
+    }
+    // QSortFilterProxyModel flips its arguments for descending sorts, so
+    // only the columns sorted against the primary direction flip here
+    foreach(const SortColumn &sc, m_sort_chain) {
+        SortKey l_key = column_key(left, sc);
+        SortKey r_key = column_key(right, sc);
+        if (l_key == r_key)
+            continue;
+        return sc.order == m_sort_order ? l_key < r_key : r_key < l_key;
+    }
+    return false; // the sort is stable, so full ties keep their order
+}
+
 void DwarfModelProxy::sort(int column, DWARF_SORT_ROLE role) {
+    m_sort_expression = DwarfExpression(); // back to the regular sort roles
+    m_sort_keys.clear();
     Qt::SortOrder order;
     if (column == 0) {
         switch(role) {
@@ -175,7 +430,8 @@ void DwarfModelProxy::sort(int column, DWARF_SORT_ROLE role) {
         }
         setSortRole(DwarfModel::DR_SORT_VALUE);
     }
-    setSortCaseSensitivity(Qt::CaseInsensitive);
-    setSortLocaleAware(true);
+    m_sort_order = order;
+    m_sort_chain.clear();
+    m_sort_chain << SortColumn(column, sortRole(), order);
     QSortFilterProxyModel::sort(column, order);
 }
@@ -0,0 +1,176 @@
+/*
+Dwarf Therapist
+Copyright (c) 2009 Trey Stout (chmod)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+#include "nameresolver.h"
+#include "dfinstance.h"
+#include "dwarftherapist.h"
+#include "word.h"
+
+QMutex NameResolver::s_mutex;
+QHash<NameResolver::NameKey, QString> NameResolver::s_names;
+
+bool NameResolver::NameKey::operator==(const NameKey &other) const {
+    if (language != other.language)
+        return false;
+    for (int i = 0; i < NAME_WORDS; ++i) {
+        if (words[i] != other.words[i])
+            return false;
+    }
+    return true;
+}
+
+uint qHash(const NameResolver::NameKey &key) {
+    uint h = key.language;
+    for (int i = 0; i < NameResolver::NAME_WORDS; ++i) {
+        h = h * 31 + key.words[i];
+    }
+    return h;
+}
+
+NameResolver::NameKey NameResolver::make_key(const QByteArray &buf,
+                                             uint offset,
+                                             NAME_LANGUAGE language) {
+    NameKey key;
+    key.language = language;
+    for (int i = 0; i < NAME_WORDS; ++i) {
+        key.words[i] = peek<quint32>(buf, offset + i * 4);
+    }
+    return key;
+}
+
+QString NameResolver::last_name(const QByteArray &buf, uint offset,
+                                NAME_LANGUAGE language) {
+    return lookup(make_key(buf, offset, language));
+}
+
+QString NameResolver::read_translated_name(DFInstance *df,
+                                           const VIRTADDR &addr) {
+    QByteArray buf;
+    if (df->read_raw(addr, NAME_BYTES, buf) != NAME_BYTES)
+        return QString();
+    return translated_name(buf, 0);
+}
+
+QString NameResolver::translated_name(const QByteArray &buf, uint offset) {
+    return lookup(make_key(buf, offset, NL_TRANSLATED));
+}
+
+void NameResolver::clear() {
+    QMutexLocker locker(&s_mutex);
+    s_names.clear();
+}
+
+QString NameResolver::lookup(const NameKey &key) {
+    {
+        QMutexLocker locker(&s_mutex);
+        QHash<NameKey, QString>::const_iterator it = s_names.constFind(key);
+        if (it != s_names.constEnd())
+            return it.value();
+    }
+    // assemble outside the lock, two threads racing here build the same name
+    QString name = key.language == NL_TRANSLATED
+                   ? assemble_translated_name(key)
+                   : assemble_last_name(key);
+    QMutexLocker locker(&s_mutex);
+    s_names.insert(key, name);
+    return name;
+}
+
+QString NameResolver::assemble_last_name(const NameKey &key) {
+    // last name reading taken from patch by Zhentar (issue 189)
+    QString chunks[3];
+    const int word_chunk[NAME_WORDS] = {0, 0, 1, -1, -1, 1, 2};
+    for (int i = 0; i < NAME_WORDS; ++i) {
+        uint word = key.words[i];
+        if (word_chunk[i] < 0 || word == 0xFFFFFFFF)
+            continue;
+        chunks[word_chunk[i]].append(key.language == NL_GENERIC
+                                     ? DT->get_generic_word(word)
+                                     : DT->get_dwarf_word(word));
+    }
+
+    QString out = capitalize(chunks[0]);
+    for (int i = 1; i < 3; ++i) {
+        if (!chunks[i].isEmpty())
+            out.append(" " + capitalize(chunks[i]));
+    }
+    return out;
+}
+
+QString NameResolver::assemble_translated_name(const NameKey &key) {
+    QString result = "The";
+
+    //7 parts e.g.  ffffffff ffffffff 000006d4
+    //      ffffffff ffffffff 000002b1 ffffffff
+    Word *words[NAME_WORDS];
+    for (int i = 0; i < NAME_WORDS; ++i) {
+        words[i] = key.words[i] == 0xFFFFFFFF ? 0 : DT->get_word(key.words[i]);
+    }
+
+    //Unknown
+    if (words[0])
+        result.append(" " + capitalize(words[0]->base()));
+    //Unknown
+    if (words[1])
+        result.append(" " + capitalize(words[1]->base()));
+    //Verb
+    if (words[2])
+        result.append(" " + capitalize(words[2]->adjective()));
+    //Unknown
+    if (words[3])
+        result.append(" " + capitalize(words[3]->base()));
+    //Unknown
+    if (words[4])
+        result.append(" " + capitalize(words[4]->base()));
+
+    //Noun
+    Word *word = words[5];
+    bool singular = false;
+    if (word) {
+        if (word->plural_noun().isEmpty()) {
+            result.append(" " + capitalize(word->noun()));
+            singular = true;
+        } else {
+            result.append(" " + capitalize(word->plural_noun()));
+        }
+    }
+
+    //of verb(noun)
+    word = words[6];
+    if (word) {
+        if (!word->verb().isEmpty()) {
+            if (singular) {
+                result.append(" of " + capitalize(word->verb()));
+            } else {
+                result.append(" of " + capitalize(word->present_participle_verb()));
+            }
+        } else {
+            if (singular) {
+                result.append(" of " + capitalize(word->noun()));
+            } else {
+                result.append(" of " + capitalize(word->plural_noun()));
+            }
+        }
+    }
+
+    return result.trimmed();
+}
@@ -25,10 +25,12 @@ THE SOFTWARE.
 #include "dwarfmodelproxy.h"
 #include "dwarftherapist.h"
 #include "defines.h"
+#include "dwarfexpression.h"
 
 RotatedHeader::RotatedHeader(Qt::Orientation orientation, QWidget *parent)
     : QHeaderView(orientation, parent)
     , m_hovered_column(-1)
+    , m_label_font("Verdana", 8)
 {
     setClickable(true);
     setSortIndicatorShown(true);
@@ -39,6 +41,8 @@ RotatedHeader::RotatedHeader(Qt::Orientation orientation, QWidget *parent)
 }
 
 void RotatedHeader::column_hover(int col) {
+    if (col == m_hovered_column)
+        return; // the grid reports every mouse move, not just column changes
     updateSection(m_hovered_column);
     m_hovered_column = col;
     updateSection(col);
@@ -53,6 +57,7 @@ void RotatedHeader::read_settings() {
         }
     }
     m_shade_column_headers = s->value("options/grid/shade_column_headers", true).toBool();
+    m_labels.clear();
 }
 
 void RotatedHeader::paintSection(QPainter *p, const QRect &rect, int idx) const {
@@ -125,14 +130,27 @@ void RotatedHeader::paintSection(QPainter *p, const QRect &rect, int idx) const
     */
 
     QString data = this->model()->headerData(idx, Qt::Horizontal).toString();
-    p->save();
-    p->setPen(Qt::black);
-    p->setRenderHint(QPainter::Antialiasing);
-    p->translate(rect.x(), rect.y());
-    p->rotate(90);
-    p->setFont(QFont("Verdana", 8));
-    p->drawText(14, -4, data);
-    p->restore();
+    p->drawPixmap(rect.topLeft(), label_pixmap(data, rect.size()));
+}
+
+QPixmap RotatedHeader::label_pixmap(const QString &text, const QSize &size) const {
+    // rotating and antialiasing text is the slowest part of a repaint, so
+    // each label is drawn once per section size and blitted from then on
+    QHash<QString, QPixmap>::const_iterator it = m_labels.constFind(text);
+    if (it != m_labels.constEnd() && it.value().size() == size)
+        return it.value();
+
+    QPixmap pixmap(size);
+    pixmap.fill(Qt::transparent);
+    QPainter p(&pixmap);
+    p.setPen(Qt::black);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.rotate(90);
+    p.setFont(m_label_font);
+    p.drawText(14, -4, text);
+    p.end();
+    m_labels.insert(text, pixmap);
+    return pixmap;
 }
 
 void RotatedHeader::resizeSection(int logicalIndex, int size) {
@@ -162,9 +180,21 @@ void RotatedHeader::mousePressEvent(QMouseEvent *e) {
     if (idx > 0 && idx < count() && e->button() == Qt::RightButton) {
         emit section_right_clicked(idx);
     }
+    if (idx >= 0 && e->button() == Qt::LeftButton &&
+        (e->modifiers() & Qt::ShiftModifier)) {
+        // add a secondary sort instead of letting the header replace the sort
+        emit add_sort_column(idx);
+        return;
+    }
     QHeaderView::mousePressEvent(e);
 }
 
+void RotatedHeader::mouseReleaseEvent(QMouseEvent *e) {
+    if (e->button() == Qt::LeftButton && (e->modifiers() & Qt::ShiftModifier))
+        return; // handled on press
+    QHeaderView::mouseReleaseEvent(e);
+}
+
 void RotatedHeader::leaveEvent(QEvent *e) {
     m_p = QPoint(-1, -1);
     QHeaderView::leaveEvent(e);
@@ -184,6 +214,8 @@ void RotatedHeader::contextMenuEvent(QContextMenuEvent *evt) {
         a->setData(DwarfModelProxy::DSR_ID_DESC);
         a = m->addAction(tr("Sort in Game Order"), this, SLOT(sort_action()));
         a->setData(DwarfModelProxy::DSR_GAME_ORDER);
+        m->addSeparator();
+        m->addAction(tr("Sort by Expression..."), this, SLOT(sort_by_expression_action()));
         m->exec(viewport()->mapToGlobal(evt->pos()));
     } else {
         /* Don't do this yet
@@ -204,6 +236,22 @@ void RotatedHeader::sort_action() {
     emit sort(0, role);
 }
 
+void RotatedHeader::sort_by_expression_action() {
+    bool ok;
+    QString text = QInputDialog::getText(this, tr("Sort by Expression"),
+        tr("Highest values first, e.g. skill(0) + trait(5) / 10"),
+        QLineEdit::Normal, m_sort_expression, &ok);
+    if (!ok || text.trimmed().isEmpty())
+        return;
+    DwarfExpression e(text);
+    if (!e.is_valid()) {
+        QMessageBox::warning(this, tr("Invalid Expression"), e.error());
+        return;
+    }
+    m_sort_expression = text;
+    emit sort_by_expression(text, Qt::DescendingOrder);
+}
+
 void RotatedHeader::toggle_set_action() {
     QAction *sender = qobject_cast<QAction*>(QObject::sender());
     QString set_name = sender->data().toString();
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "labor.h"
 #include "trait.h"
 #include "dwarftherapist.h"
+#include "dwarfexpression.h"
 
 ScriptDialog::ScriptDialog(QWidget *parent)
     : QDialog(parent)
@@ -35,6 +36,8 @@ ScriptDialog::ScriptDialog(QWidget *parent)
     ui->setupUi(this);
 
 
+    ui->text_help->append(DwarfExpression::help_text());
+
     GameDataReader *gdr = GameDataReader::ptr();
     QString labor_list = "<br><b>Labor Reference</b><table border=1 cellpadding=3 cellspacing=0 width=100%>"
         "<tr><th width=24%>Labor ID</th><th>Labor</th></tr>";
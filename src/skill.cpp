@@ -23,39 +23,15 @@ THE SOFTWARE.
 #include "skill.h"
 #include "gamedatareader.h"
 
-Skill::Skill()
-    : m_id(-1)
-    , m_exp(0)
-    , m_actual_exp(0)
-    , m_exp_for_current_level(0)
-    , m_exp_for_next_level(1)
-    , m_rating(-1)
-    , m_name("UNKNOWN")
-{}
+/* cumulative xp to reach each level, level N costs 500 + (N-1) * 100
+   formula from http://df.magmawiki.com/index.php/40d:Attribute */
+const uint Skill::LEVEL_XP[Skill::MAX_RATING + 2] = {
+    0, 500, 1100, 1800, 2600, 3500, 4500, 5600, 6800, 8100, 9500, 11000,
+    12600, 14300, 16100, 18000, 20000, 22100, 24300, 26600, 29000, 31500
+};
 
-Skill::Skill(short id, uint exp, short rating)
-    : m_id(id)
-    , m_exp(exp)
-    , m_actual_exp(exp)
-    , m_exp_for_current_level(0)
-    , m_exp_for_next_level(exp + 1)
-    , m_rating(rating > 20 ? 20 : rating)
-    , m_name("UNKNOWN")
-{
-    // formula from http://df.magmawiki.com/index.php/40d:Attribute
-    m_actual_exp = m_exp;
-    for (int i = 0; i < m_rating; ++i) {
-        m_actual_exp += 500 + (i * 100);
-    }
-    m_exp_for_current_level = 0;
-    for (int i = 0; i < m_rating; ++i) {
-        m_exp_for_current_level += 500 + (i * 100);
-    }
-    m_exp_for_next_level = 0;
-    for (int i = 0; i < m_rating + 1; ++i) {
-        m_exp_for_next_level += 500 + (i * 100);
-    }
-    m_name = GameDataReader::ptr()->get_skill_name(m_id);
+QString Skill::name() const {
+    return GameDataReader::ptr()->get_skill_name(m_id);
 }
 
 QString Skill::to_string(bool include_level, bool include_exp_summary) const {
@@ -74,20 +50,18 @@ QString Skill::to_string(bool include_level, bool include_exp_summary) const {
     return out;
 }
 
-bool Skill::operator<(const Skill &s2) const {
-    return m_rating < s2.m_rating;
-}
-
 QString Skill::exp_summary() const {
-    if (m_rating >= 20) {
-        return QString("TOTAL: %L1xp").arg(m_actual_exp);
+    if (m_rating >= MAX_RATING) {
+        return QString("TOTAL: %L1xp").arg(actual_exp());
     }
+    uint current = exp_for_current_level();
+    uint next = exp_for_next_level();
     float progress = 0.0f;
-    if (m_exp_for_next_level && m_exp_for_current_level) {
-        progress = ((float)m_exp / (float)(m_exp_for_next_level - m_exp_for_current_level)) * 100;
+    if (next && current) {
+        progress = ((float)m_exp / (float)(next - current)) * 100;
     }
     return QString("%L1xp / %L2xp (%L3%)")
-        .arg(m_actual_exp)
-        .arg(m_exp_for_next_level)
+        .arg(actual_exp())
+        .arg(next)
         .arg(progress, 0, 'f', 1);
 }
@@ -46,7 +46,7 @@ StateTableView::StateTableView(QWidget *parent)
     , m_proxy(0)
     , m_delegate(new UberDelegate(this))
     , m_header(new RotatedHeader(Qt::Horizontal, this))
-    , m_expanded_rows(QList<int>())
+    , m_expanded_groups(QStringList())
 {
     read_settings();
 
@@ -106,6 +106,9 @@ void StateTableView::set_model(DwarfModel *model, DwarfModelProxy *proxy) {
             SLOT(section_right_clicked(int)));
     connect(m_header, SIGNAL(sort(int, DwarfModelProxy::DWARF_SORT_ROLE)),
             m_proxy, SLOT(sort(int, DwarfModelProxy::DWARF_SORT_ROLE)));
+    connect(m_header, SIGNAL(sort_by_expression(const QString&, Qt::SortOrder)),
+            m_proxy, SLOT(sort_by_expression(const QString&, Qt::SortOrder)));
+    connect(m_header, SIGNAL(add_sort_column(int)), m_proxy, SLOT(add_sort_column(int)));
 
     connect(this, SIGNAL(activated(const QModelIndex&)), proxy, SLOT(cell_activated(const QModelIndex&)));
     connect(m_model, SIGNAL(preferred_header_size(int, int)), m_header, SLOT(resizeSection(int, int)));
@@ -114,6 +117,14 @@ void StateTableView::set_model(DwarfModel *model, DwarfModelProxy *proxy) {
     set_single_click_labor_changes(DT->user_settings()->value("options/single_click_labor_changes", true).toBool());
 }
 
+void StateTableView::show_columns(int first, int count) {
+    for (int col = 1; col < m_proxy->columnCount(); ++col) {
+        bool hidden = col < first || col >= first + count;
+        if (isColumnHidden(col) != hidden)
+            setColumnHidden(col, hidden);
+    }
+}
+
 void StateTableView::new_custom_profession() {
     QModelIndex idx = currentIndex();
     if (idx.isValid()) {
@@ -212,6 +223,18 @@ void StateTableView::contextMenuEvent(QContextMenuEvent *event) {
     }
 }
 
+QList<Dwarf*> StateTableView::selected_dwarves() const {
+    QList<Dwarf*> dwarves;
+    foreach(const QModelIndex idx, selectionModel()->selection().indexes()) {
+        if (idx.column() == 0 && !idx.data(DwarfModel::DR_IS_AGGREGATE).toBool()) {
+            Dwarf *d = m_model->get_dwarf_by_id(idx.data(DwarfModel::DR_ID).toInt());
+            if (d)
+                dwarves << d;
+        }
+    }
+    return dwarves;
+}
+
 void StateTableView::set_nickname() {
     const QItemSelection sel = selectionModel()->selection();
     QModelIndexList first_col;
@@ -242,7 +265,7 @@ void StateTableView::set_nickname() {
                 return;
             }
             d->set_nickname(new_nick);
-            m_model->setData(first_col[0], d->nice_name(), Qt::DisplayRole);
+            m_model->dwarf_set_toggled(d); // the name is read from the dwarf on the next paint
         }
     }
     m_model->calculate_pending();
@@ -262,26 +285,24 @@ void StateTableView::apply_custom_profession() {
     if (!cp)
         return;
 
-    const QItemSelection sel = selectionModel()->selection();
-    foreach(const QModelIndex idx, sel.indexes()) {
-        if (idx.column() == 0 && !idx.data(DwarfModel::DR_IS_AGGREGATE).toBool()) {
-            Dwarf *d = m_model->get_dwarf_by_id(idx.data(DwarfModel::DR_ID).toInt());
-            if (d)
-                d->apply_custom_profession(cp);
-        }
+    // one batch, so the touched rows repaint together at the end
+    m_model->begin_changes();
+    foreach(Dwarf *d, selected_dwarves()) {
+        d->apply_custom_profession(cp);
+        m_model->dwarf_set_toggled(d);
     }
+    m_model->end_changes();
     m_model->calculate_pending();
 }
 
 void StateTableView::reset_custom_profession() {
-    const QItemSelection sel = selectionModel()->selection();
-    foreach(const QModelIndex idx, sel.indexes()) {
-        if (idx.column() == 0 && !idx.data(DwarfModel::DR_IS_AGGREGATE).toBool()) {
-            Dwarf *d = m_model->get_dwarf_by_id(idx.data(DwarfModel::DR_ID).toInt());
-            if (d)
-                d->reset_custom_profession();
-        }
+    // one batch, so the touched rows repaint together at the end
+    m_model->begin_changes();
+    foreach(Dwarf *d, selected_dwarves()) {
+        d->reset_custom_profession();
+        m_model->dwarf_set_toggled(d);
     }
+    m_model->end_changes();
     m_model->calculate_pending();
 }
 
@@ -299,14 +320,13 @@ void StateTableView::set_custom_profession_text() {
         warn = prof_name.length() > 15;
     } while(warn);
 
-    const QItemSelection sel = selectionModel()->selection();
-    foreach(const QModelIndex idx, sel.indexes()) {
-        if (idx.column() == 0 && !idx.data(DwarfModel::DR_IS_AGGREGATE).toBool()) {
-            Dwarf *d = m_model->get_dwarf_by_id(idx.data(DwarfModel::DR_ID).toInt());
-            if (d)
-                d->set_custom_profession_text(prof_name);
-        }
+    // one batch, so the touched rows repaint together at the end
+    m_model->begin_changes();
+    foreach(Dwarf *d, selected_dwarves()) {
+        d->set_custom_profession_text(prof_name);
+        m_model->dwarf_set_toggled(d);
     }
+    m_model->end_changes();
     m_model->calculate_pending();
 
 }
@@ -380,26 +400,34 @@ void StateTableView::header_pressed(int index) {
 /* Handlers for expand/collapse persistence                             */
 /************************************************************************/
 void StateTableView::expandAll() {
-    m_expanded_rows.clear();
-    for(int i = 0; i < m_proxy->rowCount(); ++i) {
-        m_expanded_rows << i;
+    m_expanded_groups.clear();
+    // groups can nest, so walk down until the rows are dwarves
+    QList<QModelIndex> parents;
+    parents << QModelIndex();
+    while (!parents.isEmpty()) {
+        QModelIndex parent = parents.takeLast();
+        for(int i = 0; i < m_proxy->rowCount(parent); ++i) {
+            QModelIndex idx = m_proxy->index(i, 0, parent);
+            if (!m_proxy->hasChildren(idx))
+                continue;
+            m_expanded_groups << idx.data(DwarfModel::DR_GROUP_NAME).toString();
+            parents << idx;
+        }
     }
     QTreeView::expandAll();
 }
 
 void StateTableView::collapseAll() {
-    m_expanded_rows.clear();
+    m_expanded_groups.clear();
     QTreeView::collapseAll();
 }
 
 void StateTableView::index_expanded(const QModelIndex &idx) {
-    m_expanded_rows << idx.row();
+    m_expanded_groups << idx.data(DwarfModel::DR_GROUP_NAME).toString();
 }
 
 void StateTableView::index_collapsed(const QModelIndex &idx) {
-    int i = m_expanded_rows.indexOf(idx.row());
-    if (i != -1)
-        m_expanded_rows.removeAt(i);
+    m_expanded_groups.removeAll(idx.data(DwarfModel::DR_GROUP_NAME).toString());
 }
 
 void StateTableView::restore_expanded_items() {
@@ -408,8 +436,17 @@ void StateTableView::restore_expanded_items() {
         return;
     }
     disconnect(this, SIGNAL(expanded(const QModelIndex &)), 0, 0);
-    foreach(int row, m_expanded_rows) {
-        expand(m_proxy->index(row, 0));
+    QList<QModelIndex> parents;
+    parents << QModelIndex();
+    while (!parents.isEmpty()) {
+        QModelIndex parent = parents.takeLast();
+        for (int row = 0; row < m_proxy->rowCount(parent); ++row) {
+            QModelIndex idx = m_proxy->index(row, 0, parent);
+            if (m_expanded_groups.contains(idx.data(DwarfModel::DR_GROUP_NAME).toString())) {
+                expand(idx);
+                parents << idx; // subgroups are only visible under expanded groups
+            }
+        }
     }
     connect(this, SIGNAL(expanded(const QModelIndex &)), SLOT(index_expanded(const QModelIndex &)));
 }
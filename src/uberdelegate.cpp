@@ -79,6 +79,7 @@ void UberDelegate::read_settings() {
     auto_contrast = s->value("options/auto_contrast", true).toBool();
     draw_aggregates = s->value("options/show_aggregates", true).toBool();
     m_skill_drawing_method = static_cast<SKILL_DRAWING_METHOD>(s->value("options/grid/skill_drawing_method", SDM_GROWING_CENTRAL_BOX).toInt());
+    m_glyphs.clear(); // colors, padding, fonts or drawing method may have changed
 }
 
 void UberDelegate::paint(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const {
@@ -113,16 +114,15 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
         case CT_SKILL:
             {
                 short rating = model_idx.data(DwarfModel::DR_RATING).toInt();
-                QColor bg = paint_bg(adjusted, false, p, opt, idx);
-                paint_skill(adjusted, rating, bg, p, opt, idx);
-                paint_grid(adjusted, false, p, opt, idx);
+                QColor bg = model_idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
+                paint_glyph(rating, false, false, bg, p, opt);
             }
             break;
         case CT_LABOR:
             {
                 bool agg = model_idx.data(DwarfModel::DR_IS_AGGREGATE).toBool();
                 if (m_model->current_grouping() == DwarfModel::GB_NOTHING || !agg) {
-                    paint_labor(adjusted, p, opt, idx);
+                    paint_labor(p, opt, idx);
                 } else {
                     if (draw_aggregates)
                         paint_aggregate(adjusted, p, opt, idx);
@@ -135,7 +135,7 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
                 p->save();
                 p->fillRect(adjusted, model_idx.data(Qt::BackgroundColorRole).value<QColor>());
                 p->restore();
-                paint_grid(adjusted, false, p, opt, idx);
+                paint_grid(adjusted, false, p, opt);
             }
             break;
         case CT_IDLE:
@@ -146,17 +146,18 @@ void UberDelegate::paint_cell(QPainter *p, const QStyleOptionViewItem &opt, cons
                 p->save();
                 p->drawPixmap(adjusted, pixmap);
                 p->restore();
-                paint_grid(adjusted, false, p, opt, idx);
+                paint_grid(adjusted, false, p, opt);
             }
             break;
         case CT_TRAIT:
         case CT_ATTRIBUTE:
+        case CT_EXPRESSION:
             {
                 paint_bg(adjusted, false, p, opt, idx);
                 p->save();
                 p->drawText(adjusted, Qt::AlignCenter, model_idx.data(Qt::DisplayRole).toString());
                 p->restore();
-                paint_grid(adjusted, false, p, opt, idx);
+                paint_grid(adjusted, false, p, opt);
             }
             break;
         case CT_MILITARY_PREFERENCE:
@@ -190,7 +191,10 @@ QColor UberDelegate::paint_bg(const QRect &adjusted, bool active, QPainter *p, c
     QModelIndex idx = proxy_idx;
     if (m_proxy)
         idx = m_proxy->mapToSource(proxy_idx);
-    QColor bg = idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
+    return fill_bg(adjusted, active, idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>(), p, opt);
+}
+
+QColor UberDelegate::fill_bg(const QRect &adjusted, bool active, QColor bg, QPainter *p, const QStyleOptionViewItem &opt) const {
     p->save();
     p->fillRect(opt.rect, QBrush(bg));
     if (active) {
@@ -201,7 +205,7 @@ QColor UberDelegate::paint_bg(const QRect &adjusted, bool active, QPainter *p, c
     return bg;
 }
 
-void UberDelegate::paint_skill(const QRect &adjusted, int rating, QColor bg, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &) const {
+void UberDelegate::paint_skill(const QRect &adjusted, int rating, QColor bg, QPainter *p, const QStyleOptionViewItem &opt) const {
     QColor c = color_skill;
     if (auto_contrast)
         c = compliment(bg);
@@ -345,7 +349,7 @@ void UberDelegate::paint_pref(const QRect &adjusted, QPainter *p, const QStyleOp
     int labor_id = idx.data(DwarfModel::DR_LABOR_ID).toInt();
     short val = d->pref_value(labor_id);
     QString symbol = GameDataReader::ptr()->get_military_preference(labor_id)->value_symbol(val);
-    bool dirty = d->is_labor_state_dirty(labor_id);
+    bool dirty = d->is_pref_state_dirty(labor_id);
 
     QColor bg = paint_bg(adjusted, false, p, opt, proxy_idx);
     p->save();
@@ -353,10 +357,10 @@ void UberDelegate::paint_pref(const QRect &adjusted, QPainter *p, const QStyleOp
         p->setPen(QPen(compliment(bg)));
     p->drawText(opt.rect, Qt::AlignCenter, symbol);
     p->restore();
-    paint_grid(adjusted, dirty, p, opt, proxy_idx);
+    paint_grid(adjusted, dirty, p, opt);
 }
 
-void UberDelegate::paint_labor(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const {
+void UberDelegate::paint_labor(QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const {
     QModelIndex idx = m_proxy->mapToSource(proxy_idx);
     short rating = idx.data(DwarfModel::DR_RATING).toInt();
 
@@ -369,9 +373,38 @@ void UberDelegate::paint_labor(const QRect &adjusted, QPainter *p, const QStyleO
     bool enabled = d->labor_enabled(labor_id);
     bool dirty = d->is_labor_state_dirty(labor_id);
 
-    QColor bg = paint_bg(adjusted, enabled, p, opt, proxy_idx);
-    paint_skill(adjusted, rating, bg, p, opt, proxy_idx);
-    paint_grid(adjusted, dirty, p, opt, proxy_idx);
+    QColor bg = idx.data(DwarfModel::DR_DEFAULT_BG_COLOR).value<QColor>();
+    paint_glyph(rating, enabled, dirty, bg, p, opt);
+}
+
+void UberDelegate::paint_glyph(short rating, bool active, bool dirty, const QColor &bg, QPainter *p, const QStyleOptionViewItem &opt) const {
+    // everything that changes how a skill/labor cell looks, packed into one
+    // key: bg color, size, the state flags and the rating
+    bool selected = opt.state.testFlag(QStyle::State_Selected);
+    quint64 key = bg.rgba();
+    key |= quint64((rating + 1) & 0x1f) << 32;
+    key |= quint64((active ? 1 : 0) | (dirty ? 2 : 0) | (selected ? 4 : 0)) << 37;
+    key |= quint64(opt.rect.width() & 0xfff) << 40;
+    key |= quint64(opt.rect.height() & 0xfff) << 52;
+
+    QHash<quint64, QPixmap>::const_iterator it = m_glyphs.constFind(key);
+    if (it == m_glyphs.constEnd()) {
+        if (m_glyphs.size() >= MAX_CACHED_GLYPHS)
+            m_glyphs.clear();
+        // render the cell once at the origin, exactly as it would be drawn in place
+        QPixmap pixmap(opt.rect.size());
+        QStyleOptionViewItem local(opt);
+        local.rect = QRect(QPoint(0, 0), opt.rect.size());
+        QRect adjusted = local.rect.adjusted(cell_padding, cell_padding, (cell_padding * -2) - 1, (cell_padding * -2) - 1);
+        QPainter gp(&pixmap);
+        gp.setFont(p->font());
+        QColor drawn = fill_bg(adjusted, active, bg, &gp, local);
+        paint_skill(adjusted, rating, drawn, &gp, local);
+        paint_grid(adjusted, dirty, &gp, local);
+        gp.end();
+        it = m_glyphs.insert(key, pixmap);
+    }
+    p->drawPixmap(opt.rect.topLeft(), it.value());
 }
 
 void UberDelegate::paint_aggregate(const QRect &adjusted, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &proxy_idx) const {
@@ -379,31 +412,20 @@ void UberDelegate::paint_aggregate(const QRect &adjusted, QPainter *p, const QSt
         return;
     }
     QModelIndex model_idx = m_proxy->mapToSource(proxy_idx);
-    QModelIndex first_col = m_proxy->index(proxy_idx.row(), 0, proxy_idx.parent());
-    if (!first_col.isValid()) {
-        return;
-    }
-
-    QString group_name = proxy_idx.data(DwarfModel::DR_GROUP_NAME).toString();
-    int labor_id = proxy_idx.data(DwarfModel::DR_LABOR_ID).toInt();
+    int labor_id = model_idx.data(DwarfModel::DR_LABOR_ID).toInt();
 
-    int dirty_count = 0;
+    // counts cover the whole group (like toggling it does) and are kept
+    // current by the model as its members change
+    int members = 0;
     int enabled_count = 0;
-    for (int i = 0; i < m_proxy->rowCount(first_col); ++i) {
-        int dwarf_id = m_proxy->data(m_proxy->index(i, 0, first_col), DwarfModel::DR_ID).toInt();
-        Dwarf *d = m_model->get_dwarf_by_id(dwarf_id);
-        if (!d)
-            continue;
-        if (d->labor_enabled(labor_id))
-            enabled_count++;
-        if (d->is_labor_state_dirty(labor_id))
-            dirty_count++;
-    }
+    int dirty_count = 0;
+    m_model->group_labor_counts(model_idx, labor_id, members, enabled_count,
+                                dirty_count);
 
     QStyledItemDelegate::paint(p, opt, proxy_idx); // slap on the main bg
 
     p->save();
-    if (enabled_count == m_proxy->rowCount(first_col)) {
+    if (enabled_count == members) {
         p->fillRect(adjusted, QBrush(color_active_group));
     } else if (enabled_count > 0) {
         p->fillRect(adjusted, QBrush(color_partial_group));
@@ -412,10 +434,10 @@ void UberDelegate::paint_aggregate(const QRect &adjusted, QPainter *p, const QSt
     }
     p->restore();
 
-    paint_grid(adjusted, dirty_count > 0, p, opt, proxy_idx);
+    paint_grid(adjusted, dirty_count > 0, p, opt);
 }
 
-void UberDelegate::paint_grid(const QRect &adjusted, bool dirty, QPainter *p, const QStyleOptionViewItem &opt, const QModelIndex &) const {
+void UberDelegate::paint_grid(const QRect &adjusted, bool dirty, QPainter *p, const QStyleOptionViewItem &opt) const {
     p->save(); // border last
     p->setBrush(Qt::NoBrush);
     if (dirty) {
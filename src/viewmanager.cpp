@@ -264,6 +264,21 @@ StateTableView *ViewManager::get_stv(int idx) {
 }
 
 void ViewManager::setCurrentIndex(int idx) {
+    show_tab(idx, false);
+}
+
+void ViewManager::project_open_views() {
+    QList<GridView*> open_views;
+    for (int i = 0; i < count(); ++i) {
+        GridView *v = get_view(tabText(i));
+        if (v)
+            open_views << v;
+    }
+    m_model->set_grid_views(open_views);
+    m_model->build_rows();
+}
+
+void ViewManager::show_tab(int idx, bool rebuild) {
     if (idx < 0 || idx > count()-1) {
         LOGW << "tab switch to index" << idx << "requested but there are " <<
             "only" << count() << "tabs";
@@ -272,11 +287,21 @@ void ViewManager::setCurrentIndex(int idx) {
     StateTableView *stv = get_stv(idx);
     foreach(GridView *v, m_views) {
         if (v->name() == tabText(idx)) {
-            m_model->set_grid_view(v);
-            m_model->build_rows();
-            stv->header()->setResizeMode(QHeaderView::Fixed);
-            stv->header()->setResizeMode(0, QHeaderView::ResizeToContents);
-            stv->sortByColumn(0, Qt::AscendingOrder);
+            // every open tab's columns are already in the model, so a switch
+            // only changes which sections this tab's header shows
+            int first = 0;
+            int columns = 0;
+            if (rebuild || !m_model->view_columns(v, first, columns)) {
+                project_open_views();
+                m_model->view_columns(v, first, columns);
+                rebuild = true;
+            }
+            stv->show_columns(first, columns);
+            if (rebuild) {
+                stv->header()->setResizeMode(QHeaderView::Fixed);
+                stv->header()->setResizeMode(0, QHeaderView::ResizeToContents);
+                stv->sortByColumn(0, Qt::AscendingOrder);
+            }
             QList<Dwarf*> tmp_list;
             foreach(Dwarf *d, m_selected_dwarfs) {
                 tmp_list << d;
@@ -393,6 +418,12 @@ void ViewManager::set_group_by(int group_by) {
     redraw_current_tab();
 }
 
+void ViewManager::set_group_levels(const QList<int> &levels) {
+    if (m_model)
+        m_model->set_group_levels(levels);
+    redraw_current_tab();
+}
+
 void ViewManager::redraw_current_tab() {
-    setCurrentIndex(currentIndex());
+    show_tab(currentIndex(), true);
 }
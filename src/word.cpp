@@ -45,6 +45,16 @@ Word::Word(DFInstance *df, VIRTADDR address, QObject *parent)
     refresh_data();
 }
 
+Word::Word(DFInstance *df, VIRTADDR address, const QVector<QString> &members,
+           int first, QObject *parent)
+    : QObject(parent)
+    , m_address(address)
+    , m_df(df)
+    , m_mem(df->memory_layout())
+{
+    set_members(members, first);
+}
+
 Word::~Word() {
 }
 
@@ -52,11 +62,53 @@ Word* Word::get_word(DFInstance *df, const VIRTADDR & address) {
     return new Word(df, address);
 }
 
+QVector<Word*> Word::get_words(DFInstance *df, const QVector<VIRTADDR> &addresses) {
+    QVector<uint> offsets = member_offsets(df->memory_layout());
+    QVector<QString> members = df->read_struct_strings(addresses, offsets);
+    QVector<Word*> words;
+    words.reserve(addresses.size());
+    for (int i = 0; i < addresses.size(); ++i) {
+        words << new Word(df, addresses.at(i), members, i * offsets.size());
+    }
+    return words;
+}
+
+void Word::save(QDataStream &out) {
+    out << m_base << m_noun << m_plural_noun
+        << m_adjective << m_verb << m_present_simple_verb << m_past_simple_verb
+        << m_past_participle_verb << m_present_participle_verb;
+}
+
+Word* Word::load(DFInstance *df, QDataStream &in) {
+    QVector<QString> members(9);
+    for (int i = 0; i < members.size(); ++i) {
+        in >> members[i];
+    }
+    return new Word(df, 0, members, 0);
+}
+
+QVector<uint> Word::member_offsets(MemoryLayout *mem) {
+    return QVector<uint>()
+            << mem->word_offset("base")
+            << mem->word_offset("noun_singular")
+            << mem->word_offset("noun_plural")
+            << mem->word_offset("adjective")
+            << mem->word_offset("verb")
+            << mem->word_offset("present_simple_verb")
+            << mem->word_offset("past_simple_verb")
+            << mem->word_offset("past_participle_verb")
+            << mem->word_offset("present_participle_verb");
+}
+
 void Word::refresh_data() {
     if (!m_df || !m_df->memory_layout() || !m_df->memory_layout()->is_valid()) {
         LOGW << "refresh of Word called but we're not connected";
         return;
     }
+    if (!m_address) {
+        TRACE << "Word was loaded from the game data cache, nothing to refresh";
+        return;
+    }
     // make sure our reference is up to date to the active memory layout
     m_mem = m_df->memory_layout();
     TRACE << "Starting refresh of Word data at" << hexify(m_address);
@@ -65,14 +117,19 @@ void Word::refresh_data() {
 }
 
 void Word::read_members() {
-    m_base = m_df->read_string(m_address + m_mem->word_offset("base"));
-    m_noun = m_df->read_string(m_address + m_mem->word_offset("noun_singular"));
-    m_plural_noun = m_df->read_string(m_address + m_mem->word_offset("noun_plural"));
-    m_adjective = m_df->read_string(m_address + m_mem->word_offset("adjective"));
-    m_verb = m_df->read_string(m_address + m_mem->word_offset("verb"));
-    m_present_simple_verb = m_df->read_string(m_address + m_mem->word_offset("present_simple_verb"));
-    m_past_simple_verb = m_df->read_string(m_address + m_mem->word_offset("past_simple_verb"));
-    m_past_participle_verb = m_df->read_string(m_address + m_mem->word_offset("past_participle_verb"));
-    m_present_participle_verb = m_df->read_string(m_address + m_mem->word_offset("present_participle_verb"));
+    set_members(m_df->read_struct_strings(QVector<VIRTADDR>() << m_address,
+                                          member_offsets(m_mem)), 0);
+}
+
+void Word::set_members(const QVector<QString> &members, int first) {
+    m_base = members.at(first);
+    m_noun = members.at(first + 1);
+    m_plural_noun = members.at(first + 2);
+    m_adjective = members.at(first + 3);
+    m_verb = members.at(first + 4);
+    m_present_simple_verb = members.at(first + 5);
+    m_past_simple_verb = members.at(first + 6);
+    m_past_participle_verb = members.at(first + 7);
+    m_present_participle_verb = members.at(first + 8);
 }
 